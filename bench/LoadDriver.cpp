@@ -0,0 +1,315 @@
+#include "Session.hpp"
+#include "StubServer.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Load driver: every session is a forked process running the client flow, so
+// RSS and CPU are measured per session. Without --host a stub server is forked
+// on loopback for each mailbox size.
+//
+// xr2000_loadgen [--host H --port P] [--sessions 1,2,4,8] [--mails 10,100]
+//                [--words 60] [--translations 50] [--output loadgen]
+//
+// Writes <output>_latency.csv (per PacketType) and <output>_sessions.csv.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct DriverOptions {
+	std::string host;
+	std::string port;
+	std::vector<size_t> sessions{ 1, 2, 4, 8 };
+	std::vector<size_t> mails{ 10, 100 };
+	size_t words_per_mail = 60;
+	size_t max_translations = 50;
+	std::string output = "loadgen";
+};
+
+struct SessionReport {
+	bool ok;
+	std::string error;
+	std::vector<LatencySample> samples;
+	uint32_t nb_mails;
+	uint64_t duration_ns;
+	long max_rss_kb;
+	uint64_t user_cpu_us;
+	uint64_t system_cpu_us;
+};
+
+std::vector<size_t> parse_list(const std::string& value) {
+	std::vector<size_t> list;
+	std::istringstream iss(value);
+	std::string item;
+	while (std::getline(iss, item, ',')) {
+		list.push_back(std::stoul(item));
+	}
+	if (list.empty()) {
+		throw std::runtime_error("Error: Empty list " + value);
+	}
+
+	return list;
+}
+
+DriverOptions parse_options(int argc, char** argv) {
+	DriverOptions options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			throw std::runtime_error("Error: Missing value for " + arg);
+		}
+		const std::string value = argv[++i];
+
+		if (arg == "--host") {
+			options.host = value;
+		} else if (arg == "--port") {
+			options.port = value;
+		} else if (arg == "--sessions") {
+			options.sessions = parse_list(value);
+		} else if (arg == "--mails") {
+			options.mails = parse_list(value);
+		} else if (arg == "--words") {
+			options.words_per_mail = std::stoul(value);
+		} else if (arg == "--translations") {
+			options.max_translations = std::stoul(value);
+		} else if (arg == "--output") {
+			options.output = value;
+		} else {
+			throw std::runtime_error("Error: Unknown option " + arg);
+		}
+	}
+
+	if (options.host.empty() != options.port.empty()) {
+		throw std::runtime_error("Error: --host and --port go together");
+	}
+
+	return options;
+}
+
+uint64_t microseconds(const timeval& t) {
+	return static_cast<uint64_t>(t.tv_sec) * 1000000 + static_cast<uint64_t>(t.tv_usec);
+}
+
+// Child side, the report goes through a file inherited from the driver
+[[noreturn]] void session_process(const SessionOptions& options, FILE* out) {
+	int code = 0;
+	try {
+		const auto start = Clock::now();
+		const SessionResult result = run_session(options);
+		const uint64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+		for (const LatencySample& sample : result.samples) {
+			std::fprintf(out, "S %d %llu\n", static_cast<int>(sample.request), static_cast<unsigned long long>(sample.nanoseconds));
+		}
+
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		std::fprintf(out, "R %u %llu %ld %llu %llu\n", result.nb_mails, static_cast<unsigned long long>(duration), usage.ru_maxrss,
+			static_cast<unsigned long long>(microseconds(usage.ru_utime)), static_cast<unsigned long long>(microseconds(usage.ru_stime)));
+	} catch (const std::exception& e) {
+		std::fprintf(out, "E %s\n", e.what());
+		code = 1;
+	}
+
+	std::fflush(out);
+	_exit(code);
+}
+
+SessionReport read_report(FILE* in) {
+	SessionReport report{ false, "no report", {}, 0, 0, 0, 0, 0 };
+	std::rewind(in);
+
+	char kind;
+	while (std::fscanf(in, " %c", &kind) == 1) {
+		if (kind == 'S') {
+			int type;
+			unsigned long long ns;
+			if (std::fscanf(in, "%d %llu", &type, &ns) == 2) {
+				report.samples.push_back(LatencySample{ static_cast<PacketType>(type), ns });
+			}
+		} else if (kind == 'R') {
+			unsigned long long duration, user, system;
+			if (std::fscanf(in, "%u %llu %ld %llu %llu", &report.nb_mails, &duration, &report.max_rss_kb, &user, &system) == 5) {
+				report.ok = true;
+				report.error.clear();
+				report.duration_ns = duration;
+				report.user_cpu_us = user;
+				report.system_cpu_us = system;
+			}
+		} else if (kind == 'E') {
+			char message[512] = "";
+			std::fgets(message, sizeof(message), in);
+			report.error = message;
+			report.error.erase(report.error.find_last_not_of(" \n") + 1);
+		}
+	}
+
+	return report;
+}
+
+// Nearest rank
+double percentile_us(std::vector<uint64_t>& sorted_ns, double p) {
+	const size_t rank = static_cast<size_t>(std::ceil(p * sorted_ns.size()));
+	return sorted_ns[std::max<size_t>(rank, 1) - 1] / 1000.0;
+}
+
+std::string type_name(PacketType type) {
+	std::ostringstream oss;
+	oss << type;
+	const std::string name = oss.str();
+	return name.substr(name.find("::") + 2);
+}
+
+void run_scale(const DriverOptions& options, const std::string& port, size_t nb_sessions, size_t mailbox,
+               std::ofstream& latency_csv, std::ofstream& sessions_csv) {
+	const SessionOptions session_options{ options.host.empty() ? "127.0.0.1" : options.host, port, options.max_translations };
+
+	std::cout.flush();
+	std::vector<FILE*> outputs;
+	std::vector<pid_t> pids;
+	const auto start = Clock::now();
+	for (size_t i = 0; i < nb_sessions; ++i) {
+		FILE* out = std::tmpfile();
+		if (out == nullptr) {
+			throw std::runtime_error("Error: Could not create a session report file");
+		}
+		outputs.push_back(out);
+
+		const pid_t pid = fork();
+		if (pid < 0) {
+			throw std::runtime_error("Error: Could not fork a session");
+		}
+		if (pid == 0) {
+			session_process(session_options, out);
+		}
+		pids.push_back(pid);
+	}
+	for (pid_t pid : pids) {
+		waitpid(pid, nullptr, 0);
+	}
+	const double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::map<PacketType, std::vector<uint64_t>> latencies;
+	std::vector<uint64_t> all;
+	size_t failed = 0;
+	for (size_t i = 0; i < nb_sessions; ++i) {
+		const SessionReport report = read_report(outputs[i]);
+		std::fclose(outputs[i]);
+
+		if (!report.ok) {
+			++failed;
+			std::cerr << "Session " << i << ": " << report.error << std::endl;
+		}
+		if (options.host.empty() == false) {
+			mailbox = report.nb_mails;
+		}
+
+		sessions_csv << nb_sessions << "," << mailbox << "," << i << "," << (report.ok ? "ok" : "error") << ","
+		             << report.duration_ns / 1e6 << "," << report.samples.size() << "," << report.max_rss_kb << ","
+		             << report.user_cpu_us / 1e3 << "," << report.system_cpu_us / 1e3 << "\n";
+
+		for (const LatencySample& sample : report.samples) {
+			latencies[sample.request].push_back(sample.nanoseconds);
+			all.push_back(sample.nanoseconds);
+		}
+	}
+
+	const auto write_row = [&](const std::string& name, std::vector<uint64_t>& samples) {
+		std::sort(samples.begin(), samples.end());
+		latency_csv << nb_sessions << "," << mailbox << "," << name << "," << samples.size() << ","
+		            << samples.size() / wall_s << "," << percentile_us(samples, 0.50) << "," << percentile_us(samples, 0.99) << "\n";
+	};
+	for (auto& [type, samples] : latencies) {
+		write_row(type_name(type), samples);
+	}
+	if (!all.empty()) {
+		write_row("All", all);
+		std::cout << nb_sessions << " sessions, " << mailbox << " mails: " << all.size() / wall_s << " requests/s, p99 "
+		          << percentile_us(all, 0.99) << "us, " << failed << " failed" << std::endl;
+	}
+}
+
+// Listening socket on an ephemeral loopback port, served by a forked stub
+pid_t start_stub(StubConfig config, std::string& port) {
+	const int fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t length = sizeof(addr);
+	if ((fd < 0) || (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) || (listen(fd, SOMAXCONN) < 0)
+	    || (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) < 0)) {
+		throw std::runtime_error("Error: Could not listen on loopback");
+	}
+	port = std::to_string(ntohs(addr.sin_port));
+
+	std::cout.flush();
+	const pid_t pid = fork();
+	if (pid < 0) {
+		throw std::runtime_error("Error: Could not fork the stub server");
+	}
+	if (pid == 0) {
+		run_stub_server(fd, config);
+	}
+	close(fd);
+
+	return pid;
+}
+
+}
+
+int main(int argc, char** argv) {
+	try {
+		const DriverOptions options = parse_options(argc, argv);
+
+		std::ofstream latency_csv{ options.output + "_latency.csv" };
+		std::ofstream sessions_csv{ options.output + "_sessions.csv" };
+		if (!latency_csv.is_open() || !sessions_csv.is_open()) {
+			throw std::runtime_error("Error: Could not open " + options.output + " CSV files");
+		}
+		latency_csv << "sessions,mails,packet_type,requests,throughput_rps,p50_us,p99_us\n";
+		sessions_csv << "sessions,mails,session,status,duration_ms,requests,max_rss_kb,user_cpu_ms,system_cpu_ms\n";
+
+		// The mailbox size of a real server is whatever it reports
+		const std::vector<size_t> mailboxes = options.host.empty() ? options.mails : std::vector<size_t>{ 0 };
+		for (size_t mailbox : mailboxes) {
+			std::string port = options.port;
+			pid_t stub = -1;
+			if (options.host.empty()) {
+				stub = start_stub(StubConfig{ static_cast<uint32_t>(mailbox), options.words_per_mail }, port);
+			}
+
+			for (size_t nb_sessions : options.sessions) {
+				run_scale(options, port, nb_sessions, mailbox, latency_csv, sessions_csv);
+			}
+
+			if (stub > 0) {
+				kill(stub, SIGTERM);
+				waitpid(stub, nullptr, 0);
+			}
+		}
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include "Session.hpp"
+
+#include "Dictionnary.hpp"
+#include "Dispatcher.hpp"
+#include "Protocol.hpp"
+#include "TCPConnect.hpp"
+#include "TranslationPlanner.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t elapsed_ns(Clock::time_point start) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+}
+
+SessionResult run_session(const SessionOptions& options) {
+	SessionResult result{ {}, 0 };
+	Dispatcher dispatcher;
+
+	// Hello latency includes the connection
+	auto start = Clock::now();
+	TCPConnect connection{ options.host, options.port };
+	handle_hello_packet(dispatcher.wait_for(connection, { PacketType::Hello }));
+	result.samples.push_back(LatencySample{ PacketType::Hello, elapsed_ns(start) });
+
+	const CredentialInfos credential{ { 'l', 'o', 'a', 'd' }, { 'p', 'w' } };
+	start = Clock::now();
+	send_packets(connection, { write_login_packet(credential), Packet{ PacketType::GetStatus } });
+	const Result login = handle_result_packet(dispatcher.wait_for(connection, { PacketType::Result }));
+	result.samples.push_back(LatencySample{ PacketType::Login, elapsed_ns(start) });
+	if (login.error()) {
+		throw std::runtime_error("Error: Could not login: " + login.to_string());
+	}
+	const Status status = handle_status_packet(dispatcher.wait_for(connection, { PacketType::Status }));
+	result.samples.push_back(LatencySample{ PacketType::GetStatus, elapsed_ns(start) });
+	result.nb_mails = status.nb_mails.value_or(0);
+
+	std::vector<Mail> mails;
+	mails.reserve(result.nb_mails);
+	for (uint32_t i = 1; i <= result.nb_mails; ++i) {
+		start = Clock::now();
+		send_packet(connection, write_getmail_packet(i));
+		mails.push_back(handle_mail_packet(dispatcher.wait_for(connection, { PacketType::Mail })));
+		result.samples.push_back(LatencySample{ PacketType::GetMail, elapsed_ns(start) });
+	}
+
+	Dictionnary dict;
+	TranslationPlanner planner{ mails, dict };
+	for (size_t i = 0; (i < options.max_translations) && !planner.done(); ++i) {
+		const PlannedWord& word = planner.next();
+
+		start = Clock::now();
+		send_packet(connection, write_translate_packet(word.word));
+		const Packet reply = dispatcher.wait_for(connection, { PacketType::Translation, PacketType::Result });
+		result.samples.push_back(LatencySample{ PacketType::Translate, elapsed_ns(start) });
+
+		bool translated = false;
+		if (reply.type == PacketType::Translation) {
+			dict[word.word] = handle_translation_packet(reply);
+			translated = true;
+		} else if (handle_result_packet(reply).code != 0x50) {
+			throw std::runtime_error("Error: could not translate word");
+		}
+		planner.pop(translated);
+	}
+
+	return result;
+}
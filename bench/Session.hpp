@@ -0,0 +1,30 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Packet.hpp"
+
+struct LatencySample {
+	PacketType request;
+	uint64_t nanoseconds; // Request sent to reply received
+};
+
+struct SessionOptions {
+	std::string host;
+	std::string port;
+	size_t max_translations;
+};
+
+struct SessionResult {
+	std::vector<LatencySample> samples;
+	uint32_t nb_mails;
+};
+
+// Flow of the client without disk or rate limit pauses:
+// Hello, Login + GetStatus, GetMail for every mail, Translate the unknown words
+SessionResult run_session(const SessionOptions& options);
+
+#endif
@@ -0,0 +1,164 @@
+#include "StubServer.hpp"
+
+#include "Packet.hpp"
+#include "Protocol.hpp"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t VocabularySize = 512;
+
+bool read_exact(int fd, uint8_t* data, size_t size) {
+	size_t received = 0;
+	while (received < size) {
+		const ssize_t bytes = ::recv(fd, data + received, size - received, 0);
+		if (bytes <= 0) {
+			return false;
+		}
+		received += static_cast<size_t>(bytes);
+	}
+
+	return true;
+}
+
+// std::nullopt once the client is gone or out of sync
+std::optional<Packet> read_packet(int fd) {
+	uint8_t header[5];
+	if (!read_exact(fd, header, sizeof(header)) || !std::equal(header + 1, header + 5, Packet::Magic)) {
+		return std::nullopt;
+	}
+
+	std::optional<uint8_t> request_id;
+	if (header[0] & 0b00100000) {
+		uint8_t id;
+		if (!read_exact(fd, &id, 1)) {
+			return std::nullopt;
+		}
+		request_id = id;
+	}
+
+	uint8_t length_bytes[4] = { 0, 0, 0, 0 };
+	if (!read_exact(fd, length_bytes, LFL_to_LF(header[0] >> 6))) {
+		return std::nullopt;
+	}
+	const uint32_t length = length_bytes[0] | (length_bytes[1] << 8) | (length_bytes[2] << 16) | (static_cast<uint32_t>(length_bytes[3]) << 24);
+
+	std::vector<uint8_t> payload(length);
+	if (!read_exact(fd, payload.data(), length)) {
+		return std::nullopt;
+	}
+
+	return Packet{ static_cast<PacketType>(header[0] & 0b00011111), request_id, std::move(payload) };
+}
+
+void write_packet(int fd, const Packet& p) {
+	std::vector<char> data;
+	serialize_packet(data, p);
+
+	size_t sent = 0;
+	while (sent < data.size()) {
+		const ssize_t bytes = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if (bytes <= 0) {
+			return;
+		}
+		sent += static_cast<size_t>(bytes);
+	}
+}
+
+// Deterministic pseudo words, 3 to 8 letters
+std::string vocabulary_word(size_t index) {
+	uint64_t h = (index + 1) * 0x9e3779b97f4a7c15;
+	std::string word(3 + h % 6, 'a');
+	for (char& c : word) {
+		h = h * 6364136223846793005 + 1442695040888963407;
+		c = static_cast<char>('a' + (h >> 33) % 26);
+	}
+
+	return word;
+}
+
+std::string mail_content(uint32_t id, size_t nb_words) {
+	std::string content;
+	uint64_t h = id * 0xbf58476d1ce4e5b9 + 1;
+	for (size_t i = 0; i < nb_words; ++i) {
+		h = h * 6364136223846793005 + 1442695040888963407;
+		if (!content.empty()) {
+			content += ((i % 12) == 0) ? ". " : " ";
+		}
+		content += vocabulary_word((h >> 33) % VocabularySize);
+	}
+
+	return content + ".";
+}
+
+void serve(int fd, StubConfig config) {
+	const auto connected = std::chrono::steady_clock::now();
+	write_packet(fd, Packet{ PacketType::Hello, HelloSchema::encode(1, "stub", "Load test stand-in") });
+
+	while (const std::optional<Packet> request = read_packet(fd)) {
+		const std::optional<uint8_t> id = request->request_id;
+		switch (request->type) {
+			case PacketType::Help:
+				write_packet(fd, Packet{ PacketType::Documentation, id, std::vector<uint8_t>(256, 'd') });
+				break;
+			case PacketType::Register:
+				write_packet(fd, Packet{ PacketType::Registered, id, CredentialSchema::encode({ 's', 't', 'u', 'b' }, { 'p', 'w' }) });
+				break;
+			case PacketType::GetStatus: {
+				const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - connected);
+				write_packet(fd, Packet{ PacketType::Status, id, StatusSchema::encode(config.nb_mails, static_cast<uint32_t>(elapsed.count()), 0) });
+				break;
+			}
+			case PacketType::GetMail: {
+				const auto fields = GetMailSchema::decode(request->payload_view());
+				const uint32_t mail_id = fields.has_value() ? std::get<0>(*fields) : 0;
+				if ((mail_id == 0) || (mail_id > config.nb_mails)) {
+					write_packet(fd, Packet{ PacketType::Result, id, ResultSchema::encode(0x40) });
+				} else {
+					write_packet(fd, Packet{ PacketType::Mail, id, MailSchema::encode(mail_id, 1700000000 + mail_id, "stub", mail_content(mail_id, config.words_per_mail)) });
+				}
+				break;
+			}
+			case PacketType::Translate: {
+				// A quarter of the words are not rasvakian
+				const auto fields = TranslateSchema::decode(request->payload_view());
+				const std::string word = fields.has_value() ? std::get<0>(*fields) : std::string{};
+				if (std::hash<std::string>{}(word) % 4 == 0) {
+					write_packet(fd, Packet{ PacketType::Result, id, ResultSchema::encode(0x50) });
+				} else {
+					write_packet(fd, Packet{ PacketType::Translation, id, TranslationSchema::encode(std::string(word.rbegin(), word.rend())) });
+				}
+				break;
+			}
+			default: // Login, SendMail, Configure...
+				write_packet(fd, Packet{ PacketType::Result, id, ResultSchema::encode(0x00) });
+		}
+	}
+
+	::close(fd);
+}
+
+}
+
+void run_stub_server(int listen_fd, StubConfig config) {
+	while (true) {
+		const int fd = ::accept(listen_fd, nullptr, nullptr);
+		if (fd >= 0) {
+			// Back to back replies must not wait for the client's delayed ACK
+			const int one = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			std::thread{ serve, fd, config }.detach();
+		}
+	}
+}
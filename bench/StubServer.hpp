@@ -0,0 +1,17 @@
+#ifndef STUBSERVER_HPP
+#define STUBSERVER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// Loopback stand-in for the XR2000 server, only the requests of the main flow.
+// Replies carry the request id of their request.
+struct StubConfig {
+	uint32_t nb_mails;
+	size_t words_per_mail;
+};
+
+// Serve every connection accepted on listen_fd, one thread each, until the process is killed
+[[noreturn]] void run_stub_server(int listen_fd, StubConfig config);
+
+#endif
@@ -0,0 +1,25 @@
+#include "Protocol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// First byte picks the decoder, the rest is the payload. Malformed payloads
+// must be rejected with std::nullopt: any exception or out of bounds read is a finding.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	if (size == 0) {
+		return 0;
+	}
+
+	const std::vector<uint8_t> payload(data + 1, data + size);
+	switch (data[0] % 6) {
+		case 0: decode_hello(Packet{ PacketType::Hello, payload }); break;
+		case 1: decode_registered(Packet{ PacketType::Registered, payload }); break;
+		case 2: decode_result(Packet{ PacketType::Result, payload }); break;
+		case 3: decode_status(Packet{ PacketType::Status, payload }); break;
+		case 4: decode_translation(Packet{ PacketType::Translation, payload }); break;
+		case 5: decode_mail(Packet{ PacketType::Mail, payload }); break;
+	}
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+#include "Packet.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+// Re-serialising allocates the payload, keep it small
+constexpr uint32_t MaxReserializedLength = 1 << 16;
+
+// Field by field decode written independently of parse_header
+bool matches_reference(const uint8_t* data, size_t size, const PacketHeader& header) {
+	const bool has_request_id = data[0] & 0b00100000;
+	const uint8_t LF = LFL_to_LF(data[0] >> 6);
+	if (size != size_t{ 5 } + has_request_id + LF) {
+		return false;
+	}
+
+	uint32_t length = 0;
+	for (size_t i = 0; i < LF; ++i) {
+		length |= static_cast<uint32_t>(data[5 + has_request_id + i]) << (8*i);
+	}
+
+	return (static_cast<uint8_t>(header.type) == (data[0] & 0b00011111))
+	    && (header.request_id.has_value() == has_request_id)
+	    && (!has_request_id || (*header.request_id == data[5]))
+	    && (header.payload_length == length);
+}
+
+}
+
+// Frame header decoder, whatever the first byte announces. A header is
+// accepted iff its size and magic are right, and decodes to the reference.
+// A header using the minimal length field also serialises back to the input
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	const std::optional<PacketHeader> header = parse_header({ data, size });
+
+	const bool well_formed = (size > 0) && (size == header_size(data[0]))
+	                      && std::equal(std::begin(Packet::Magic), std::end(Packet::Magic), data + 1);
+	if (header.has_value() != well_formed) {
+		__builtin_trap();
+	}
+	if (!header.has_value()) {
+		return 0;
+	}
+
+	if (!matches_reference(data, size, *header)) {
+		__builtin_trap();
+	}
+
+	const uint8_t LF = LFL_to_LF(data[0] >> 6);
+	if ((LF == compute_LF(header->payload_length)) && (header->payload_length <= MaxReserializedLength)) {
+		std::vector<char> serialized;
+		serialize_packet(serialized, Packet{ header->type, header->request_id, std::vector<uint8_t>(header->payload_length) });
+		if ((serialized.size() != size + header->payload_length)
+		    || !std::equal(data, data + size, reinterpret_cast<const uint8_t*>(serialized.data()))) {
+			__builtin_trap();
+		}
+	}
+
+	return 0;
+}
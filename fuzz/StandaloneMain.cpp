@@ -0,0 +1,24 @@
+// Replay inputs given as files when libFuzzer is not available (GCC builds)
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int main(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		std::ifstream infile{ argv[i], std::ios::binary };
+		if (!infile.is_open()) {
+			std::cerr << "Error: Could not open " << argv[i] << std::endl;
+			return 1;
+		}
+
+		const std::vector<uint8_t> data{ std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>() };
+		LLVMFuzzerTestOneInput(data.data(), data.size());
+	}
+
+	return 0;
+}
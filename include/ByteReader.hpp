@@ -0,0 +1,87 @@
+#ifndef BYTEREADER_HPP
+#define BYTEREADER_HPP
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// Cursor over received bytes. Every read is bounds checked and reports failure
+// by returning false, leaving the cursor untouched, so malformed input is
+// rejected without exceptions.
+class ByteReader {
+public:
+	explicit ByteReader(std::span<const uint8_t> bytes)
+		: m_bytes{ bytes }
+		, m_offset{ 0 } { }
+
+	size_t offset() const {
+		return m_offset;
+	}
+
+	size_t remaining() const {
+		return m_bytes.size() - m_offset;
+	}
+
+	bool empty() const {
+		return remaining() == 0;
+	}
+
+	// Little endian integer
+	template <std::unsigned_integral T>
+	bool read_le(T& v) {
+		return read_le(v, sizeof(T));
+	}
+
+	// Little endian integer stored on nb_bytes, at most sizeof(T)
+	template <std::unsigned_integral T>
+	bool read_le(T& v, size_t nb_bytes) {
+		if ((nb_bytes > sizeof(T)) || (remaining() < nb_bytes)) {
+			return false;
+		}
+
+		const uint8_t* cur = m_bytes.data() + m_offset;
+		if constexpr (std::endian::native == std::endian::little) {
+			v = 0;
+			std::memcpy(&v, cur, nb_bytes);
+		} else {
+			v = 0;
+			for (size_t i = 0; i < nb_bytes; ++i) {
+				v |= static_cast<T>(cur[i]) << (8*i);
+			}
+		}
+		m_offset += nb_bytes;
+
+		return true;
+	}
+
+	// Next size bytes, without copy
+	bool read_span(size_t size, std::span<const uint8_t>& out) {
+		if (remaining() < size) {
+			return false;
+		}
+
+		out = m_bytes.subspan(m_offset, size);
+		m_offset += size;
+
+		return true;
+	}
+
+	// Consume bytes only if they come next
+	bool expect(std::span<const uint8_t> bytes) {
+		if ((remaining() < bytes.size()) || (std::memcmp(m_bytes.data() + m_offset, bytes.data(), bytes.size()) != 0)) {
+			return false;
+		}
+
+		m_offset += bytes.size();
+
+		return true;
+	}
+
+private:
+	std::span<const uint8_t> m_bytes;
+	size_t m_offset;
+};
+
+#endif
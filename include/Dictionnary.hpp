@@ -0,0 +1,88 @@
+#ifndef DICTIONNARY_HPP
+#define DICTIONNARY_HPP
+
+#include "DiskWriter.hpp"
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Open addressing table, keys and values are slices of a single string arena
+// and hashes are kept in the slots, so a lookup touches one slot and the arena.
+// No erase: words are only ever learnt.
+class Dictionnary {
+public:
+	// Assignable mapped value, invalidated by the next insertion
+	class Value {
+	public:
+		Value& operator=(std::string_view translation);
+		operator std::string_view() const;
+
+	private:
+		friend class Dictionnary;
+		Value(Dictionnary& dict, size_t slot);
+
+		Dictionnary& m_dict;
+		size_t m_slot;
+	};
+
+	Dictionnary();
+
+	bool contains(std::string_view w) const;
+
+	// Throw std::out_of_range when w is unknown
+	std::string_view operator[](std::string_view w) const;
+	// Insert w with an empty translation when unknown
+	Value operator[](std::string_view w);
+
+	size_t size() const;
+	// Changed by every insertion or assignment, unique across the process:
+	// two dictionnaries with different contents never share a generation
+	uint64_t generation() const;
+
+	template <typename Fn>
+	void for_each(Fn fn) const {
+		for (const Slot& slot : m_slots) {
+			if (slot.hash != EmptyHash) {
+				fn(key(slot), value(slot));
+			}
+		}
+	}
+
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+	void read_on_disk(std::string filepath);
+
+private:
+	static constexpr uint64_t EmptyHash = 0;
+
+	struct Slot {
+		uint64_t hash;
+		uint32_t key_offset;
+		uint32_t key_length;
+		uint32_t value_offset;
+		uint32_t value_length;
+	};
+
+	static uint64_t hash(std::string_view w);
+
+	// Slot holding w, or the empty slot where it belongs
+	size_t find(std::string_view w, uint64_t h) const;
+	uint32_t append(std::string_view bytes);
+	void grow();
+	// Drop values replaced by an assignment
+	void compact();
+
+	std::string_view key(const Slot& slot) const;
+	std::string_view value(const Slot& slot) const;
+
+	std::vector<Slot> m_slots; // Power of two
+	std::string m_arena;
+	size_t m_size;
+	size_t m_wasted; // Arena bytes of replaced values
+	uint64_t m_generation;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef DISKWRITER_HPP
+#define DISKWRITER_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous whole file writes, so protocol threads never wait on the disk.
+// A dedicated thread takes every pending request as one batch: successive
+// writes of a same file are coalesced and each file is synced once per batch.
+// io_uring is used when available, pwritev otherwise.
+class DiskWriter {
+public:
+	explicit DiskWriter(bool durable = true);
+	DiskWriter(const DiskWriter&) = delete;
+	DiskWriter& operator=(const DiskWriter&) = delete;
+	~DiskWriter();
+
+	// Replace the file content, the future holds the write or sync error if any
+	std::future<void> write(std::string filepath, std::string data);
+
+	// Replace the file content by data followed by tail, which is written in place.
+	// tail_owner keeps the tail bytes alive until the write completed
+	std::future<void> write(std::string filepath, std::string data, std::span<const uint8_t> tail, std::shared_ptr<const void> tail_owner);
+
+	// Wait for every submitted write, rethrow the first error since last flush
+	void flush();
+
+	bool uses_io_uring() const;
+
+private:
+	struct Request {
+		std::string filepath;
+		std::string data;
+		std::span<const uint8_t> tail;
+		std::shared_ptr<const void> tail_owner;
+		std::promise<void> done;
+	};
+
+	// One file of a batch, with every request it completes
+	struct FileWrite {
+		std::string filepath;
+		std::string data;
+		std::span<const uint8_t> tail;
+		std::shared_ptr<const void> tail_owner;
+		std::vector<std::promise<void>> done;
+		int fd;
+		std::string error;
+		unsigned pending_completions = 0; // io_uring requests submitted and not completed
+		bool completed = false;           // Written, or failed, through io_uring
+
+		size_t size() const;
+	};
+
+	void run();
+	void write_batch(std::vector<FileWrite>& files);
+	// Files already completed through io_uring are skipped
+	void write_batch_pwritev(std::vector<FileWrite>& files);
+	void write_batch_io_uring(std::vector<FileWrite>& files);
+	// After a submit or wait error the ring state is unknown, it is never used again
+	void drop_ring();
+
+	bool m_durable;
+	void* m_ring; // io_uring instance, nullptr when unavailable
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::vector<Request> m_pending;
+	size_t m_in_flight;
+	bool m_stop;
+	std::exception_ptr m_error;
+
+	std::thread m_thread;
+};
+
+#endif
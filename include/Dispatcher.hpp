@@ -0,0 +1,53 @@
+#ifndef DISPATCHER_HPP
+#define DISPATCHER_HPP
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+
+#include "Packet.hpp"
+
+class TCPConnect;
+
+// Route incoming packets either to the caller waiting for them or to the handler
+// registered for their type, so the server can push packets at any time
+class Dispatcher {
+public:
+	using Handler = std::function<void(const Packet&)>;
+	// Tells the response apart from pushed packets of the same type
+	using Matcher = std::function<bool(const Packet&)>;
+
+	// Packet type is 5 bits wide
+	static constexpr size_t NbPacketTypes = 32;
+
+	static constexpr size_t index(PacketType type) {
+		return static_cast<size_t>(type) & (NbPacketTypes - 1);
+	}
+
+	static constexpr uint32_t mask(std::initializer_list<PacketType> types) {
+		uint32_t m = 0;
+		for (PacketType type : types) {
+			m |= uint32_t{ 1 } << index(type);
+		}
+
+		return m;
+	}
+
+	// Handler for unsolicited packets of the given type
+	void on(PacketType type, Handler handler);
+
+	// Receive until a packet of one of the expected types arrives, and is
+	// accepted by matches when given
+	Packet wait_for(TCPConnect& connection, std::initializer_list<PacketType> expected);
+	Packet wait_for(TCPConnect& connection, uint32_t expected_mask, const Matcher& matches = nullptr);
+
+	// Give back expected packets, hand the others to their handler
+	std::optional<Packet> route(Packet p, uint32_t expected_mask, const Matcher& matches = nullptr) const;
+
+private:
+	std::array<Handler, NbPacketTypes> m_handlers;
+};
+
+#endif
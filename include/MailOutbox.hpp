@@ -0,0 +1,54 @@
+#ifndef MAILOUTBOX_HPP
+#define MAILOUTBOX_HPP
+
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Dispatcher.hpp"
+#include "DiskWriter.hpp"
+#include "Protocol.hpp"
+
+class TCPConnect;
+
+struct SendReport {
+	size_t sent;
+	size_t failed; // Kept in the outbox for the next send
+};
+
+// Mails waiting to be sent. send() keeps up to window SendMail requests in
+// flight, each tagged with a request id, and matches the Result packets by id
+// so a whole batch costs about one round trip. Mails the server refused stay
+// queued with their result, so retrying only sends them again. On a connection
+// error every mail stays queued: delivery is at least once.
+class MailOutbox {
+public:
+	// One request id per mail in flight
+	static constexpr size_t MaxWindow = 256;
+
+	struct Entry {
+		OutgoingMail mail;
+		std::optional<Result> last_result; // Of the previous failed attempt
+	};
+
+	void push(OutgoingMail mail);
+
+	SendReport send(TCPConnect& connection, Dispatcher& dispatcher, size_t window = 32);
+
+	const std::vector<Entry>& pending() const;
+	size_t size() const;
+
+	// Unsent mails survive restarts
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+	void read_on_disk(std::string filepath);
+
+private:
+	std::string serialize() const;
+
+	std::vector<Entry> m_pending;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef MAILPIPELINE_HPP
+#define MAILPIPELINE_HPP
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Protocol.hpp"
+#include "SPSCQueue.hpp"
+
+struct StageMetrics {
+	size_t processed;
+	QueueMetrics queue;
+};
+
+// Overlap network, translation and disk work:
+// caller (network) -> translation thread -> persistence thread
+class MailPipeline {
+public:
+	// Translated content, std::nullopt when the mail does not need translation
+	using TranslateStage = std::function<std::optional<std::string>(const Mail& mail)>;
+	using PersistStage = std::function<void(const Mail& mail, const std::optional<std::string>& translation)>;
+
+	MailPipeline(TranslateStage translate, PersistStage persist, size_t capacity = 64);
+	MailPipeline(const MailPipeline&) = delete;
+	MailPipeline& operator=(const MailPipeline&) = delete;
+	~MailPipeline();
+
+	// Block when the translation stage is behind
+	void push(Mail mail);
+
+	// Wait for every mail to be persisted and return them in push order.
+	// Rethrow the first error raised by a stage
+	std::vector<Mail> finish();
+
+	StageMetrics translate_metrics() const;
+	StageMetrics persist_metrics() const;
+
+private:
+	struct Job {
+		Mail mail;
+		std::optional<std::string> translation;
+	};
+
+	void run_translate();
+	void run_persist();
+
+	TranslateStage m_translate;
+	PersistStage m_persist;
+
+	SPSCQueue<Job> m_to_translate;
+	SPSCQueue<Job> m_to_persist;
+	std::atomic<size_t> m_translated;
+	std::atomic<size_t> m_persisted;
+
+	// Owned by the stage threads until they are joined
+	std::vector<Mail> m_done;
+	std::exception_ptr m_translate_error;
+	std::exception_ptr m_persist_error;
+
+	std::thread m_translate_thread;
+	std::thread m_persist_thread;
+};
+
+#endif
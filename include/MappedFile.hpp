@@ -0,0 +1,27 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Unnamed temporary file mapped in memory, its pages are backed by the disk
+// instead of the heap. The file disappears with the object.
+class MappedFile {
+public:
+	// Temporary directory when directory is empty
+	MappedFile(const std::string& directory, size_t size);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	std::span<uint8_t> bytes();
+	std::span<const uint8_t> bytes() const;
+
+private:
+	int m_fd;
+	uint8_t* m_data;
+	size_t m_size;
+};
+
+#endif
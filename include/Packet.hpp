@@ -0,0 +1,103 @@
+#ifndef PACKET_HPP
+#define PACKET_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+class TCPConnect;
+
+enum class PacketType {
+	Help          = 0x00,
+	Hello         = 0x01,
+	Documentation = 0x02,
+	Register      = 0x03,
+	Registered    = 0x04,
+	Login         = 0x05,
+	GetStatus     = 0x07,
+	Status        = 0x08,
+	GetMail       = 0x09,
+	Mail          = 0x0a,
+	SendMail      = 0x0b,
+	Configure     = 0x12,
+	Route         = 0x14,
+	Translate     = 0x15,
+	Translation   = 0x16,
+	Result        = 0x1f,
+};
+
+std::ostream& operator<<(std::ostream& out, PacketType value);
+
+struct Packet {
+	static constexpr uint8_t Magic[] = { 0x58, 0x52, 0x32, 0x4b };
+
+	PacketType type;
+	std::optional<uint8_t> request_id;
+	std::vector<uint8_t> payload;
+	// Received payload too large to be kept in memory, payload is then empty
+	std::shared_ptr<const MappedFile> spilled_payload;
+
+	Packet(PacketType type, std::optional<uint8_t> request_id, std::vector<uint8_t> payload = {})
+		: type{ type }
+		, request_id{ std::move(request_id) }
+		, payload{ std::move(payload) } { }
+
+	Packet(PacketType type, std::vector<uint8_t> payload = {})
+		: type{ type }
+		, request_id{ std::nullopt }
+		, payload{ std::move(payload) } { }
+
+	Packet(PacketType type, std::optional<uint8_t> request_id, std::shared_ptr<const MappedFile> spilled_payload)
+		: type{ type }
+		, request_id{ std::move(request_id) }
+		, spilled_payload{ std::move(spilled_payload) } { }
+
+	// Payload wherever it was received
+	std::span<const uint8_t> payload_view() const;
+
+	void pprint() const;
+};
+
+// Convert lenght field length to actual length field
+uint8_t LFL_to_LF(uint8_t LFL);
+
+// Convert lenght field to length field length
+uint8_t LF_to_LFL(uint8_t LF);
+
+uint8_t compute_LF(uint32_t payload_size);
+
+// First byte, magic, optional request id and payload length
+struct PacketHeader {
+	static constexpr size_t MaxSize = 1 + 4 + 1 + 4;
+
+	PacketType type;
+	std::optional<uint8_t> request_id;
+	uint32_t payload_length;
+};
+
+// Whole header size, given by its first byte
+size_t header_size(uint8_t first_byte);
+
+// std::nullopt unless bytes hold exactly one header with a valid magic
+std::optional<PacketHeader> parse_header(std::span<const uint8_t> bytes);
+
+// Payloads above TCPOptions::spill_threshold are received in a MappedFile
+Packet recv_packet(TCPConnect& connection);
+
+// Size of the packet on the wire
+size_t packet_size(const Packet& p);
+
+// Append the wire representation of the packet to data
+void serialize_packet(std::vector<char>& data, const Packet& p);
+
+void send_packet(TCPConnect& connection, const Packet& p);
+
+// Pipeline several requests in a single write
+void send_packets(TCPConnect& connection, const std::vector<Packet>& packets);
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef PACKETSCHEMA_HPP
+#define PACKETSCHEMA_HPP
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ByteReader.hpp"
+
+// Compile-time description of packet payloads.
+// A payload layout is written as Schema<Field...>, and encode/decode are generated from it.
+// Every field exposes:
+//   value_type            C++ type handed to / returned by the codec
+//   min_size, is_fixed    size known at compile time (length prefix included)
+//   size(v)               encoded size of a value
+//   write(out, v)         write the value, return the advanced pointer
+//   read<Reserved>(r, v)  read the value from a ByteReader, Reserved being the bytes needed by the following fields
+namespace schema {
+
+// Fixed width little endian integer
+template <std::unsigned_integral T>
+struct LE {
+	using value_type = T;
+
+	static constexpr size_t min_size = sizeof(T);
+	static constexpr bool is_fixed = true;
+
+	static constexpr size_t size(const value_type&) {
+		return sizeof(T);
+	}
+
+	static uint8_t* write(uint8_t* out, const value_type& v) {
+		if constexpr (std::endian::native == std::endian::little) {
+			std::memcpy(out, &v, sizeof(T));
+		} else {
+			for (size_t i = 0; i < sizeof(T); ++i) {
+				out[i] = static_cast<uint8_t>((v >> (8*i)) & 0xFF);
+			}
+		}
+
+		return out + sizeof(T);
+	}
+
+	template <size_t Reserved>
+	static bool read(ByteReader& reader, value_type& v) {
+		return reader.read_le(v);
+	}
+};
+
+// Replace the container content, char containers are assigned from a pointer
+// so that no temporary is built from the uint8_t iterators.
+// A std::string_view is pointed at the decoded bytes, nothing is copied
+template <typename Container>
+void assign_bytes(Container& v, std::span<const uint8_t> bytes) {
+	if constexpr (std::is_same_v<Container, std::string_view>) {
+		v = std::string_view{ reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+	} else if constexpr (std::is_same_v<typename Container::value_type, char>) {
+		v.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	} else {
+		v.assign(bytes.begin(), bytes.end());
+	}
+}
+
+// Byte sequence preceded by its length, as a little endian LengthT
+template <std::unsigned_integral LengthT, typename Container>
+struct Prefixed {
+	using value_type = Container;
+
+	static constexpr size_t min_size = sizeof(LengthT);
+	static constexpr bool is_fixed = false;
+
+	static constexpr size_t size(const value_type& v) {
+		return sizeof(LengthT) + v.size();
+	}
+
+	static uint8_t* write(uint8_t* out, const value_type& v) {
+		if (v.size() > std::numeric_limits<LengthT>::max()) {
+			throw std::runtime_error("Error: Field too long for its length prefix");
+		}
+
+		out = LE<LengthT>::write(out, static_cast<LengthT>(v.size()));
+		if (!v.empty()) {
+			std::memcpy(out, v.data(), v.size());
+		}
+
+		return out + v.size();
+	}
+
+	template <size_t Reserved>
+	static bool read(ByteReader& reader, value_type& v) {
+		LengthT length;
+		std::span<const uint8_t> bytes;
+		// Do not copy a length that leaves no room for the following fields
+		if (!reader.read_le(length) || (reader.remaining() < Reserved + static_cast<size_t>(length))
+		    || !reader.read_span(length, bytes)) {
+			return false;
+		}
+
+		assign_bytes(v, bytes);
+
+		return true;
+	}
+};
+
+// Everything up to the end of the payload, must be the last field
+template <typename Container>
+struct Rest {
+	using value_type = Container;
+
+	static constexpr size_t min_size = 0;
+	static constexpr bool is_fixed = false;
+
+	static constexpr size_t size(const value_type& v) {
+		return v.size();
+	}
+
+	static uint8_t* write(uint8_t* out, const value_type& v) {
+		if (!v.empty()) {
+			std::memcpy(out, v.data(), v.size());
+		}
+
+		return out + v.size();
+	}
+
+	template <size_t Reserved>
+	static bool read(ByteReader& reader, value_type& v) {
+		static_assert(Reserved == 0, "Rest must be the last field of a schema");
+		std::span<const uint8_t> bytes;
+		reader.read_span(reader.remaining(), bytes);
+		assign_bytes(v, bytes);
+
+		return true;
+	}
+};
+
+using U8String = Prefixed<uint8_t, std::string>;
+using U8Blob = Prefixed<uint8_t, std::vector<uint8_t>>;
+using U32String = Prefixed<uint32_t, std::string>;
+using U32StringView = Prefixed<uint32_t, std::string_view>; // Only valid while the payload is
+using U32Blob = Prefixed<uint32_t, std::vector<uint8_t>>;
+
+template <typename... Fields>
+struct Schema {
+	using Values = std::tuple<typename Fields::value_type...>;
+
+	static constexpr size_t min_size = (Fields::min_size + ... + 0);
+	static constexpr bool is_fixed = (Fields::is_fixed && ...);
+
+	static constexpr size_t size(const typename Fields::value_type&... values) {
+		return (Fields::size(values) + ... + 0);
+	}
+
+	static std::vector<uint8_t> encode(const typename Fields::value_type&... values) {
+		std::vector<uint8_t> payload(size(values...));
+
+		uint8_t* out = payload.data();
+		((out = Fields::write(out, values)), ...);
+
+		return payload;
+	}
+
+	// Return std::nullopt on truncated payload, overflowing length or trailing bytes
+	static std::optional<Values> decode(std::span<const uint8_t> payload) {
+		if (is_fixed ? (payload.size() != min_size) : (payload.size() < min_size)) {
+			return std::nullopt;
+		}
+
+		// Decoded in place, the returned optional is not a copy of the fields
+		std::optional<Values> values{ std::in_place };
+		ByteReader reader{ payload };
+
+		const bool valid = [&]<size_t... I>(std::index_sequence<I...>) {
+			return (Fields::template read<reserved_after(I)>(reader, std::get<I>(*values)) && ...);
+		}(std::index_sequence_for<Fields...>{});
+
+		if (!valid || !reader.empty()) {
+			return std::nullopt;
+		}
+
+		return values;
+	}
+
+private:
+	// Minimum number of bytes the fields following the index one need
+	static constexpr size_t reserved_after(size_t index) {
+		constexpr std::array<size_t, sizeof...(Fields)> sizes{ Fields::min_size... };
+
+		size_t reserved = 0;
+		for (size_t i = index + 1; i < sizes.size(); ++i) {
+			reserved += sizes[i];
+		}
+
+		return reserved;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef PHRASETRANSLATOR_HPP
+#define PHRASETRANSLATOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Dictionnary.hpp"
+
+// Dictionnary compiled into a byte trie. Replace the longest key starting and
+// ending on a word boundary, so keys may be multi-word phrases ("good morning").
+// Same splitter and case folding semantics as translate(): the text is folded
+// first, then each byte is read once unless a phrase prefix fails to match.
+class PhraseTranslator {
+public:
+	explicit PhraseTranslator(const Dictionnary& dict);
+	explicit PhraseTranslator(const std::unordered_map<std::string, std::string>& mapping);
+
+	std::string translate(std::string_view text) const;
+
+	size_t size() const;
+	// Keys spanning several words
+	size_t nb_phrases() const;
+
+private:
+	static constexpr uint32_t NoValue = UINT32_MAX;
+
+	struct Node {
+		uint32_t first_edge;
+		uint32_t nb_edges;
+		uint32_t value;
+	};
+
+	void build(const std::vector<std::pair<std::string_view, std::string_view>>& entries);
+
+	// Child of node through byte, 0 (the root) when there is none
+	uint32_t child(uint32_t node, uint8_t byte) const;
+
+	// Nodes in breadth first order, edges of a node are contiguous and sorted
+	std::vector<Node> m_nodes;
+	std::vector<uint8_t> m_edge_bytes;
+	std::vector<uint32_t> m_edge_targets;
+	std::vector<std::string> m_values;
+	size_t m_nb_phrases;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Dictionnary.hpp"
+#include "DiskWriter.hpp"
+#include "Packet.hpp"
+#include "PacketSchema.hpp"
+
+// Payload layouts
+using HelloSchema         = schema::Schema<schema::LE<uint8_t>, schema::U8String, schema::U8String>;
+using CredentialSchema    = schema::Schema<schema::U8Blob, schema::U8Blob>;
+using ResultSchema        = schema::Schema<schema::LE<uint8_t>>;
+using StatusSchema        = schema::Schema<schema::LE<uint32_t>, schema::LE<uint32_t>, schema::LE<uint8_t>>;
+using ConfigurationSchema = schema::Schema<schema::LE<uint32_t>, schema::LE<uint32_t>, schema::LE<uint8_t>>;
+using GetMailSchema       = schema::Schema<schema::LE<uint32_t>>;
+using MailSchema          = schema::Schema<schema::LE<uint32_t>, schema::LE<uint32_t>, schema::U8String, schema::U32String>;
+using MailViewSchema      = schema::Schema<schema::LE<uint32_t>, schema::LE<uint32_t>, schema::U8String, schema::U32StringView>;
+using TranslateSchema     = schema::Schema<schema::Rest<std::string>>;
+using TranslationSchema   = schema::Schema<schema::Rest<std::string>>;
+using ServerInfosSchema   = schema::Schema<schema::U32Blob, schema::U32Blob>;
+using SendMailSchema      = schema::Schema<schema::U8String, schema::U32String>;
+
+struct Hello {
+	uint8_t protocol_version;
+	std::string hostname;
+	std::string instruction;
+
+	void pprint() const;
+};
+
+// Hello and Documentation payloads kept between runs to skip Help
+struct ServerInfos {
+	std::vector<uint8_t> hello;
+	std::vector<uint8_t> documentation;
+
+	// Cached documentation still valid for the protocol the server announced
+	bool is_current(const Hello& current) const;
+
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+	// Only the hello is loaded, the documentation stays on disk
+	void read_on_disk(std::string filepath);
+
+	// Same file, written straight from the packets: a spilled documentation is
+	// written from its mapping without being copied
+	static std::future<void> save_on_disk(DiskWriter& writer, std::string filepath, const Packet& hello, const Packet& documentation);
+};
+
+struct CredentialInfos {
+	std::vector<uint8_t> username;
+	std::vector<uint8_t> password;
+
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+	void read_on_disk(std::string filepath);
+
+	void pprint() const;
+};
+
+struct Result {
+	uint8_t code;
+
+	bool success() const;
+	bool error() const;
+
+	std::string to_string() const;
+
+	void pprint() const;
+};
+
+struct Status {
+	std::optional<uint32_t> nb_mails;
+	uint32_t connection_time;
+	bool authenticated;
+	bool authorized; // Tranceiver usage
+	bool configured;
+
+	void pprint() const;
+};
+
+struct Configuration {
+	uint32_t frequency;
+	uint32_t baudrate;
+	uint8_t modulation;
+
+	// Prevent spoil
+	void read_on_disk(const std::string& filepath);
+
+	void pprint();
+};
+
+struct Mail {
+	uint32_t id;
+	uint32_t timestamp;
+	std::string sender_username;
+	std::string content;
+
+	// Content of a spilled Mail packet, read in place from the mapping
+	// spilled_payload keeps alive. content is then left empty
+	std::shared_ptr<const MappedFile> spilled_payload = nullptr;
+	std::string_view spilled_content = {};
+
+	// Content wherever it is stored
+	std::string_view text() const;
+
+	// Replace the content, the mapping is released
+	void set_text(std::string text);
+
+	void pprint() const;
+
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+
+	void translate(const Dictionnary& dict);
+};
+
+// Mail to send, mirrors the Mail layout: recipient then content
+struct OutgoingMail {
+	std::string recipient;
+	std::string content;
+
+	bool operator==(const OutgoingMail&) const = default;
+};
+
+// std::nullopt on malformed payload, never throw
+std::optional<Hello> decode_hello(const Packet& p);
+std::optional<CredentialInfos> decode_registered(const Packet& p);
+std::optional<Result> decode_result(const Packet& p);
+std::optional<Status> decode_status(const Packet& p);
+std::optional<std::string> decode_translation(const Packet& p);
+std::optional<Mail> decode_mail(const Packet& p);
+// Id of a Mail packet, the rest of the payload is not decoded
+std::optional<uint32_t> decode_mail_id(const Packet& p);
+
+// Throw std::runtime_error on malformed payload
+Hello handle_hello_packet(const Packet& p);
+void handle_doc_packet(const Packet& p);
+CredentialInfos handle_registered_packet(const Packet& p);
+Result handle_result_packet(const Packet& p);
+Status handle_status_packet(const Packet& p);
+std::string handle_translation_packet(const Packet& p);
+Mail handle_mail_packet(const Packet& p);
+
+Packet write_login_packet(const CredentialInfos& credential);
+Packet write_configuration_packet(const Configuration& config);
+Packet write_translate_packet(const std::string& word);
+Packet write_getmail_packet(uint32_t mail_id);
+Packet write_sendmail_packet(const OutgoingMail& mail, std::optional<uint8_t> request_id = std::nullopt);
+
+#endif
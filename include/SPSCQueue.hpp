@@ -0,0 +1,181 @@
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct QueueMetrics {
+	size_t capacity;
+	size_t max_occupancy; // Seen by the consumer each time it caught up
+	size_t full_waits;  // Producer blocked by backpressure
+	size_t empty_waits; // Consumer starved
+};
+
+// Bounded single producer / single consumer ring.
+// push/pop are lock free while the ring is neither full nor empty, a side only
+// sleeps on a condition variable when it has to wait for the other one.
+template <typename T>
+class SPSCQueue {
+public:
+	explicit SPSCQueue(size_t capacity)
+		: m_slots(std::bit_ceil(std::max<size_t>(capacity, 2)))
+		, m_mask{ m_slots.size() - 1 } { }
+
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	// Producer side
+	bool try_push(T& value) {
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_cached_head == m_slots.size()) {
+			m_cached_head = m_head.load(std::memory_order_acquire);
+			if (tail - m_cached_head == m_slots.size()) {
+				return false;
+			}
+		}
+
+		m_slots[tail & m_mask] = std::move(value);
+		m_tail.store(tail + 1, std::memory_order_release);
+
+		m_not_empty.wake();
+		return true;
+	}
+
+	// Block while the ring is full
+	void push(T value) {
+		if (try_push(value)) {
+			return;
+		}
+
+		m_full_waits.fetch_add(1, std::memory_order_relaxed);
+		m_not_full.sleep_until([&] { return try_push(value); });
+	}
+
+	// No more push, wake up the consumer once the ring is drained
+	void close() {
+		m_closed.store(true, std::memory_order_release);
+		m_not_empty.wake();
+	}
+
+	// Consumer side
+	bool try_pop(T& value) {
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_cached_tail) {
+			m_cached_tail = m_tail.load(std::memory_order_acquire);
+			if (head == m_cached_tail) {
+				return false;
+			}
+
+			// Sampled when the consumer catches up, both indexes are then current
+			const size_t occupancy = m_cached_tail - head;
+			if (occupancy > m_max_occupancy.load(std::memory_order_relaxed)) {
+				m_max_occupancy.store(occupancy, std::memory_order_relaxed);
+			}
+		}
+
+		value = std::move(m_slots[head & m_mask]);
+		m_head.store(head + 1, std::memory_order_release);
+
+		m_not_full.wake();
+		return true;
+	}
+
+	// Block while the ring is empty, std::nullopt once closed and drained
+	std::optional<T> pop() {
+		T value;
+		if (try_pop(value)) {
+			return value;
+		}
+
+		m_empty_waits.fetch_add(1, std::memory_order_relaxed);
+		bool popped = false;
+		m_not_empty.sleep_until([&] {
+			popped = try_pop(value);
+			return popped || m_closed.load(std::memory_order_acquire);
+		});
+
+		// Pushed right before closing
+		if (!popped && !try_pop(value)) {
+			return std::nullopt;
+		}
+
+		return value;
+	}
+
+	size_t size() const {
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const {
+		return m_slots.size();
+	}
+
+	QueueMetrics metrics() const {
+		return QueueMetrics {
+			capacity(),
+			m_max_occupancy.load(std::memory_order_relaxed),
+			m_full_waits.load(std::memory_order_relaxed),
+			m_empty_waits.load(std::memory_order_relaxed)
+		};
+	}
+
+private:
+	// Sleeping side of the ring, the other side only takes the lock if someone sleeps
+	struct Waiter {
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::atomic<bool> sleeping{ false };
+
+		template <typename Ready>
+		void sleep_until(Ready ready) {
+			// Short spin first, the other side is often just behind
+			for (size_t i = 0; i < 64; ++i) {
+				if (ready()) {
+					return;
+				}
+				std::this_thread::yield();
+			}
+
+			std::unique_lock lock{ mutex };
+			sleeping.store(true, std::memory_order_relaxed);
+			// Pairs with wake(): either we see the other side progress or it sees us sleeping
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			cv.wait(lock, ready);
+			sleeping.store(false, std::memory_order_relaxed);
+		}
+
+		void wake() {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (sleeping.load(std::memory_order_relaxed)) {
+				std::lock_guard lock{ mutex };
+				cv.notify_one();
+			}
+		}
+	};
+
+	std::vector<T> m_slots;
+	const size_t m_mask;
+
+	alignas(64) std::atomic<size_t> m_head{ 0 };
+	size_t m_cached_tail{ 0 }; // Consumer copy of m_tail
+
+	alignas(64) std::atomic<size_t> m_tail{ 0 };
+	size_t m_cached_head{ 0 }; // Producer copy of m_head
+
+	alignas(64) std::atomic<bool> m_closed{ false };
+	std::atomic<size_t> m_max_occupancy{ 0 };
+	std::atomic<size_t> m_full_waits{ 0 };
+	std::atomic<size_t> m_empty_waits{ 0 };
+
+	Waiter m_not_empty;
+	Waiter m_not_full;
+};
+
+#endif
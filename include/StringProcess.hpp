@@ -2,6 +2,7 @@
 #define STRINGPROCESS_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -11,7 +12,10 @@ bool has_alphanumeric(const std::string& str);
 
 bool is_splitter(unsigned char c);
 
-std::vector<std::string> get_unique_words(const std::string& text);
+// Occurrences of each lowercase alphabetic word
+std::unordered_map<std::string, size_t> count_words(std::string_view text);
+
+std::vector<std::string> get_unique_words(std::string_view text);
 
 std::string translate(const std::string& text, const std::unordered_map<std::string, std::string>& mapping);
 
@@ -5,21 +5,75 @@
 #include <vector>
 #include <cstdint>
 #include <queue>
+#include <chrono>
+#include <optional>
+#include <span>
+
+#include <sys/socket.h>
+
+struct TCPOptions {
+	// Small request packets must not wait for Nagle's algorithm
+	bool no_delay = true;
+	std::optional<int> recv_buffer_size;
+	std::optional<int> send_buffer_size;
+
+	// Delay before starting the next connection attempt (RFC 8305)
+	std::chrono::milliseconds attempt_delay{ 250 };
+	std::chrono::milliseconds attempt_timeout{ 5000 };
+
+	// Larger payloads are received in a temporary file of spill_directory
+	size_t spill_threshold = 16 * 1024 * 1024;
+	std::string spill_directory; // Temporary directory when empty
+};
+
+// Connection plumbing of TCPConnect, exposed for tests
+namespace tcp_detail {
+
+struct ResolvedAdress {
+	int family;
+	int socktype;
+	int protocol;
+	sockaddr_storage addr;
+	socklen_t addr_length;
+};
+
+// IPv6 and IPv4 adresses alternated, IPv6 first, each family in resolution order,
+// so that a dead IPv6 route does not delay the IPv4 attempts (RFC 8305)
+std::vector<ResolvedAdress> interleave_families(const std::vector<ResolvedAdress>& adresses);
+
+// Race connection attempts started attempt_delay apart, return the first established socket or -1
+int connect_any(const std::vector<ResolvedAdress>& adresses, const TCPOptions& options);
+
+}
 
 class TCPConnect {
 public:
-	TCPConnect(std::string server_adress, std::string port_str);
+	TCPConnect(std::string server_adress, std::string port_str, TCPOptions options = {});
+	TCPConnect(const TCPConnect&) = delete;
+	TCPConnect& operator=(const TCPConnect&) = delete;
+	~TCPConnect();
 
 	std::queue<uint8_t>& bytes();
 	void clear_bytes();
 
 	size_t recv();
+	// Receive straight into buffer, pending bytes must have been consumed
+	size_t recv(std::span<uint8_t> buffer);
 	void send(const std::vector<char>& data) const;
 
+	const TCPOptions& options() const;
+
+	// Connected socket, e.g. to inspect its options
+	int native_handle() const;
+
+	// Resolved adresses are kept for the lifetime of the process
+	static void clear_address_cache();
+
 private:
 	int sock;
 	std::string m_server_adress;
 	std::string m_port_str;
+	TCPOptions m_options;
 
 	std::queue<uint8_t> m_pending_bytes;
 };
@@ -0,0 +1,136 @@
+#ifndef TOKENIZER_HPP
+#define TOKENIZER_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace utf8 {
+
+// Code point starting at text[i] and its encoded length, std::nullopt when the
+// sequence is invalid (truncated, overlong, surrogate or out of range)
+std::optional<char32_t> decode(std::string_view text, size_t i, size_t& length);
+void append(std::string& out, char32_t cp);
+
+// Letters of the Latin, Greek, Cyrillic, Armenian, Hebrew, Arabic and CJK
+// blocks, lowercase mapping of the bicameral ones
+bool is_letter(char32_t cp);
+char32_t to_lower(char32_t cp);
+
+}
+
+// Split text on a configurable set of ASCII splitters and lowercase the tokens.
+// ASCII bytes are classified by a 256 entry table, eight byte blocks without any
+// high bit skip UTF-8 decoding and append their letters by runs. Invalid UTF-8
+// bytes are kept as is.
+class Tokenizer {
+public:
+	static constexpr std::string_view DefaultSplitters = ",.:- \n()";
+
+	explicit Tokenizer(std::string_view splitters = DefaultSplitters);
+
+	bool is_splitter(unsigned char c) const;
+
+	// Lowercase copy, splitters stay at the same offsets
+	std::string fold(std::string_view text) const;
+
+	// fn(const std::string& word) for each lowercase token made only of letters
+	template <typename Fn>
+	void for_each_word(std::string_view text, Fn fn) const {
+		scan(text, [](char) { }, [&fn](const std::string& token, bool letters) {
+			if (letters) {
+				fn(token);
+			}
+		});
+	}
+
+	// on_splitter(char) for each splitter, on_token(const std::string&, bool letters)
+	// for each lowercase run of non splitters, in text order
+	template <typename OnSplitter, typename OnToken>
+	void scan(std::string_view text, OnSplitter on_splitter, OnToken on_token) const {
+		std::string token;
+		bool letters = true;
+		const auto flush = [&] {
+			if (!token.empty()) {
+				on_token(token, letters);
+				token.clear();
+			}
+			letters = true;
+		};
+		const auto ascii = [&](unsigned char c) {
+			switch (m_classes[c]) {
+				case Class::Splitter: flush(); on_splitter(static_cast<char>(c)); break;
+				case Class::Upper: token += static_cast<char>(c | 0x20); break;
+				case Class::Lower: token += static_cast<char>(c); break;
+				default: token += static_cast<char>(c); letters = false;
+			}
+		};
+
+		const size_t length = text.size();
+		size_t i = 0;
+		while (i < length) {
+			uint64_t block;
+			if (i + sizeof(block) <= length) {
+				std::memcpy(&block, text.data() + i, sizeof(block));
+				if ((block & 0x8080808080808080) == 0) {
+					// Setting 0x20 lowercases every ASCII letter, runs of letters are
+					// appended from the folded block at once
+					char folded[sizeof(block)];
+					const uint64_t lower = block | 0x2020202020202020;
+					std::memcpy(folded, &lower, sizeof(lower));
+					size_t k = 0;
+					while (k < sizeof(block)) {
+						size_t end = k;
+						while ((end < sizeof(block)) && is_letter(static_cast<unsigned char>(text[i + end]))) {
+							++end;
+						}
+						if (end == k) {
+							ascii(static_cast<unsigned char>(text[i + k]));
+							++k;
+							continue;
+						}
+						token.append(folded + k, end - k);
+						k = end;
+					}
+					i += sizeof(block);
+					continue;
+				}
+			}
+
+			const unsigned char c = text[i];
+			if (c < 0x80) {
+				ascii(c);
+				++i;
+				continue;
+			}
+
+			size_t size = 1;
+			const std::optional<char32_t> cp = utf8::decode(text, i, size);
+			if (cp.has_value() && utf8::is_letter(*cp)) {
+				utf8::append(token, utf8::to_lower(*cp));
+			} else {
+				token.append(text.substr(i, size));
+				letters = false;
+			}
+			i += size;
+		}
+		flush();
+	}
+
+private:
+	enum class Class : uint8_t { Other, Splitter, Upper, Lower };
+
+	std::array<Class, 256> m_classes;
+
+	bool is_letter(unsigned char c) const {
+		return (m_classes[c] == Class::Upper) || (m_classes[c] == Class::Lower);
+	}
+};
+
+// Tokenizer on the mail splitters
+const Tokenizer& default_tokenizer();
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TRANSLATIONCACHE_HPP
+#define TRANSLATIONCACHE_HPP
+
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Dictionnary.hpp"
+#include "DiskWriter.hpp"
+#include "PacketSchema.hpp"
+#include "PhraseTranslator.hpp"
+
+struct CachedTranslation {
+	std::string content;
+	size_t nb_words;
+	size_t nb_translated_words;
+
+	bool complete() const;
+};
+
+// Translated contents kept between runs, keyed by a hash of the original content.
+// The content length and a second hash are checked on every hit, so a key
+// collision is a miss and never the translation of another content.
+// Each entry remembers the words it uses and a fingerprint of their mapping, so
+// learning a word only invalidates the entries using it. Checking an entry costs
+// one lookup per word, the content is neither tokenised nor translated again.
+// Learning a multi-word phrase invalidates every entry.
+// At most capacity entries are kept, the least recently used is evicted first.
+// Not thread safe.
+class TranslationCache {
+public:
+	// hash, length, check, fingerprint, nb_translated_words, words, translated content
+	using RecordSchema = schema::Schema<schema::LE<uint64_t>, schema::LE<uint64_t>, schema::LE<uint64_t>, schema::LE<uint64_t>, schema::LE<uint32_t>, schema::U32String, schema::U32String>;
+
+	static constexpr size_t DefaultCapacity = 4096;
+
+	explicit TranslationCache(size_t capacity = DefaultCapacity);
+
+	// nullptr when unknown or outdated
+	const CachedTranslation* find(std::string_view content, const Dictionnary& dict);
+
+	// Cached translation, rendered again if needed
+	const CachedTranslation& translate(std::string_view content, const Dictionnary& dict);
+
+	size_t size() const;
+
+	// Drop the entries of every content not listed, e.g. mails no longer on the server
+	void retain(const std::vector<std::string_view>& contents);
+
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+	void read_on_disk(std::string filepath);
+
+private:
+	struct Entry {
+		uint64_t length; // Original content, tells apart colliding keys
+		uint64_t check;
+		uint64_t last_used;
+		std::vector<std::string> words;
+		uint64_t fingerprint; // Mapping of words when rendered
+		CachedTranslation translation;
+	};
+
+	// Rebuild the phrase translator when the dictionnary changed
+	void refresh(const Dictionnary& dict);
+
+	std::string serialize() const;
+
+	// Make room for one more entry
+	void evict();
+
+	size_t m_capacity;
+	uint64_t m_clock = 0; // Last use order
+	std::unordered_map<uint64_t, Entry> m_entries;
+
+	std::optional<PhraseTranslator> m_translator;
+	uint64_t m_translator_generation = 0;
+	uint64_t m_phrases_fingerprint = 0; // Fingerprint seed, covers phrase keys
+};
+
+// Stable across runs, unlike std::hash
+uint64_t content_hash(std::string_view content);
+
+#endif
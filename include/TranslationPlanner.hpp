@@ -0,0 +1,58 @@
+#ifndef TRANSLATIONPLANNER_HPP
+#define TRANSLATIONPLANNER_HPP
+
+#include <future>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "Dictionnary.hpp"
+#include "DiskWriter.hpp"
+#include "Protocol.hpp"
+
+// Words the server refused to translate (Result 0x50): not rasvakian, never asked again.
+// Saved one word per line
+struct RejectedWords {
+	std::unordered_set<std::string> words;
+
+	bool contains(const std::string& word) const;
+
+	void save_on_disk(std::string filepath) const;
+	std::future<void> save_on_disk(DiskWriter& writer, std::string filepath) const;
+	void read_on_disk(std::string filepath);
+};
+
+struct PlannedWord {
+	std::string word;
+	size_t occurrences;        // Across every mail, expected coverage gain
+	std::vector<size_t> mails; // Index of the mails using the word
+};
+
+// Order Translate requests so that the most frequent unknown words come first,
+// useful output then appears long before the rate limited queue is drained.
+// Rejected words are not planned and do not count in the coverage
+class TranslationPlanner {
+public:
+	TranslationPlanner(const std::vector<Mail>& mails, const Dictionnary& dict, const RejectedWords& rejected = {});
+
+	bool done() const;
+	size_t remaining() const;
+
+	const PlannedWord& next() const;
+
+	// Next word has been handled, translated or not
+	void pop(bool translated);
+
+	// Share of word occurrences the dictionnary can translate
+	double coverage() const;
+
+private:
+	std::vector<PlannedWord> m_plan;
+	size_t m_next;
+
+	size_t m_total_occurrences;
+	size_t m_known_occurrences;
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "Dictionnary.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t InitialCapacity = 16;
+
+// Shared by every dictionnary, a generation never describes two contents
+std::atomic<uint64_t> last_generation{ 0 };
+
+uint64_t next_generation() {
+	return last_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// One "key\tvalue" line per entry, phrase keys and values may hold spaces
+std::string dictionnary_text(const Dictionnary& dict) {
+	std::ostringstream oss;
+	dict.for_each([&oss](std::string_view key, std::string_view value) {
+		if ((key.find_first_of("\t\n") != std::string_view::npos) || (value.find('\n') != std::string_view::npos)) {
+			throw std::runtime_error("Error: Dictionnary entry can not be saved: " + std::string(key));
+		}
+		oss << key << "\t" << value << "\n";
+	});
+
+	return oss.str();
+}
+
+}
+
+Dictionnary::Value::Value(Dictionnary& dict, size_t slot)
+	: m_dict{ dict }
+	, m_slot{ slot } { }
+
+Dictionnary::Value& Dictionnary::Value::operator=(std::string_view translation) {
+	Slot& slot = m_dict.m_slots[m_slot];
+	if (translation == m_dict.value(slot)) {
+		return *this;
+	}
+
+	m_dict.m_wasted += slot.value_length;
+	slot.value_offset = m_dict.append(translation);
+	slot.value_length = static_cast<uint32_t>(translation.size());
+	m_dict.m_generation = next_generation();
+
+	if (m_dict.m_wasted > m_dict.m_arena.size() / 2) {
+		m_dict.compact();
+	}
+
+	return *this;
+}
+
+Dictionnary::Value::operator std::string_view() const {
+	return m_dict.value(m_dict.m_slots[m_slot]);
+}
+
+Dictionnary::Dictionnary()
+	: m_slots(InitialCapacity, Slot{ EmptyHash, 0, 0, 0, 0 })
+	, m_size{ 0 }
+	, m_wasted{ 0 }
+	, m_generation{ next_generation() } { }
+
+bool Dictionnary::contains(std::string_view w) const {
+	return m_slots[find(w, hash(w))].hash != EmptyHash;
+}
+
+std::string_view Dictionnary::operator[](std::string_view w) const {
+	const Slot& slot = m_slots[find(w, hash(w))];
+	if (slot.hash == EmptyHash) {
+		throw std::out_of_range("Error: Unknown word " + std::string(w));
+	}
+
+	return value(slot);
+}
+
+Dictionnary::Value Dictionnary::operator[](std::string_view w) {
+	const uint64_t h = hash(w);
+	size_t index = find(w, h);
+	if (m_slots[index].hash != EmptyHash) {
+		return Value{ *this, index };
+	}
+
+	// Keep the load factor under 3/4
+	if ((m_size + 1) * 4 > m_slots.size() * 3) {
+		grow();
+		index = find(w, h);
+	}
+
+	m_slots[index] = Slot{ h, append(w), static_cast<uint32_t>(w.size()), 0, 0 };
+	++m_size;
+	m_generation = next_generation();
+
+	return Value{ *this, index };
+}
+
+size_t Dictionnary::size() const {
+	return m_size;
+}
+
+uint64_t Dictionnary::generation() const {
+	return m_generation;
+}
+
+uint64_t Dictionnary::hash(std::string_view w) {
+	const uint64_t h = std::hash<std::string_view>{}(w);
+	return (h == EmptyHash) ? 1 : h;
+}
+
+size_t Dictionnary::find(std::string_view w, uint64_t h) const {
+	const size_t mask = m_slots.size() - 1;
+	size_t index = h & mask;
+	while (true) {
+		const Slot& slot = m_slots[index];
+		if ((slot.hash == EmptyHash) || ((slot.hash == h) && (key(slot) == w))) {
+			return index;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+uint32_t Dictionnary::append(std::string_view bytes) {
+	if (m_arena.size() + bytes.size() > std::numeric_limits<uint32_t>::max()) {
+		throw std::runtime_error("Error: Dictionnary is full");
+	}
+
+	const uint32_t offset = static_cast<uint32_t>(m_arena.size());
+	m_arena.append(bytes);
+	return offset;
+}
+
+void Dictionnary::grow() {
+	std::vector<Slot> slots(m_slots.size() * 2, Slot{ EmptyHash, 0, 0, 0, 0 });
+	const size_t mask = slots.size() - 1;
+
+	// Stored hashes, no key is hashed again
+	for (const Slot& slot : m_slots) {
+		if (slot.hash == EmptyHash) {
+			continue;
+		}
+
+		size_t index = slot.hash & mask;
+		while (slots[index].hash != EmptyHash) {
+			index = (index + 1) & mask;
+		}
+		slots[index] = slot;
+	}
+
+	m_slots.swap(slots);
+}
+
+void Dictionnary::compact() {
+	std::string arena;
+	arena.reserve(m_arena.size() - m_wasted);
+	for (Slot& slot : m_slots) {
+		if (slot.hash == EmptyHash) {
+			continue;
+		}
+
+		const uint32_t key_offset = static_cast<uint32_t>(arena.size());
+		arena.append(key(slot));
+		const uint32_t value_offset = static_cast<uint32_t>(arena.size());
+		arena.append(value(slot));
+		slot.key_offset = key_offset;
+		slot.value_offset = value_offset;
+	}
+
+	m_arena.swap(arena);
+	m_wasted = 0;
+}
+
+std::string_view Dictionnary::key(const Slot& slot) const {
+	return std::string_view{ m_arena }.substr(slot.key_offset, slot.key_length);
+}
+
+std::string_view Dictionnary::value(const Slot& slot) const {
+	return std::string_view{ m_arena }.substr(slot.value_offset, slot.value_length);
+}
+
+void Dictionnary::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::binary };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save dictionnary");
+	}
+
+	outfile << dictionnary_text(*this);
+
+	outfile.close();
+}
+
+std::future<void> Dictionnary::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	return writer.write(std::move(filepath), dictionnary_text(*this));
+}
+
+void Dictionnary::read_on_disk(std::string filepath) {
+	std::ifstream infile{ filepath, std::ios::binary };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read dictionnary");
+	}
+
+	// Files written before phrases were separated by the first space
+	std::string line;
+	while (std::getline(infile, line)) {
+		size_t separator = line.find('\t');
+		if (separator == std::string::npos) {
+			separator = line.find(' ');
+		}
+		if (separator == std::string::npos) {
+			continue;
+		}
+
+		const std::string_view entry{ line };
+		(*this)[entry.substr(0, separator)] = entry.substr(separator + 1);
+	}
+
+	infile.close();
+}
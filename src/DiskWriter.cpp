@@ -0,0 +1,303 @@
+#include "DiskWriter.hpp"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef XR2000_HAS_IO_URING
+#include <liburing.h>
+#endif
+
+namespace {
+
+#ifdef XR2000_HAS_IO_URING
+// Write + fsync per file
+constexpr unsigned QueueDepth = 64;
+#endif
+
+std::string errno_message(const std::string& action, const std::string& filepath, int error) {
+	return "Error: Could not " + action + " " + filepath + ": " + std::strerror(error);
+}
+
+}
+
+DiskWriter::DiskWriter(bool durable)
+	: m_durable{ durable }
+	, m_ring{ nullptr }
+	, m_in_flight{ 0 }
+	, m_stop{ false }
+{
+#ifdef XR2000_HAS_IO_URING
+	io_uring* ring = new io_uring;
+	// Kernel without io_uring or syscall filtered: fall back to pwritev
+	if (io_uring_queue_init(QueueDepth, ring, 0) < 0) {
+		delete ring;
+	} else {
+		m_ring = ring;
+	}
+#endif
+
+	m_thread = std::thread{ &DiskWriter::run, this };
+}
+
+DiskWriter::~DiskWriter() {
+	{
+		std::lock_guard lock{ m_mutex };
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+
+	drop_ring();
+}
+
+void DiskWriter::drop_ring() {
+#ifdef XR2000_HAS_IO_URING
+	if (m_ring != nullptr) {
+		io_uring_queue_exit(static_cast<io_uring*>(m_ring));
+		delete static_cast<io_uring*>(m_ring);
+		m_ring = nullptr;
+	}
+#endif
+}
+
+size_t DiskWriter::FileWrite::size() const {
+	return data.size() + tail.size();
+}
+
+std::future<void> DiskWriter::write(std::string filepath, std::string data) {
+	return write(std::move(filepath), std::move(data), {}, nullptr);
+}
+
+std::future<void> DiskWriter::write(std::string filepath, std::string data, std::span<const uint8_t> tail, std::shared_ptr<const void> tail_owner) {
+	std::promise<void> done;
+	std::future<void> result = done.get_future();
+
+	{
+		std::lock_guard lock{ m_mutex };
+		m_pending.push_back(Request{ std::move(filepath), std::move(data), tail, std::move(tail_owner), std::move(done) });
+		++m_in_flight;
+	}
+	m_cv.notify_all();
+
+	return result;
+}
+
+void DiskWriter::flush() {
+	std::unique_lock lock{ m_mutex };
+	m_cv.wait(lock, [this] { return m_in_flight == 0; });
+
+	if (m_error) {
+		std::exception_ptr error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+bool DiskWriter::uses_io_uring() const {
+	return m_ring != nullptr;
+}
+
+void DiskWriter::run() {
+	while (true) {
+		std::vector<Request> batch;
+		{
+			std::unique_lock lock{ m_mutex };
+			m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+			if (m_pending.empty()) { // Stopped and drained
+				return;
+			}
+			batch.swap(m_pending);
+		}
+
+		// Only the last content of a file submitted in the batch is written
+		std::vector<FileWrite> files;
+		std::unordered_map<std::string, size_t> file_index;
+		for (Request& request : batch) {
+			const auto [it, inserted] = file_index.try_emplace(request.filepath, files.size());
+			if (inserted) {
+				files.push_back(FileWrite{ std::move(request.filepath), std::move(request.data), request.tail, std::move(request.tail_owner), {}, -1, {} });
+			} else {
+				FileWrite& file = files[it->second];
+				file.data = std::move(request.data);
+				file.tail = request.tail;
+				file.tail_owner = std::move(request.tail_owner);
+			}
+			files[it->second].done.push_back(std::move(request.done));
+		}
+
+		write_batch(files);
+
+		std::exception_ptr first_error = nullptr;
+		for (FileWrite& file : files) {
+			for (std::promise<void>& done : file.done) {
+				if (file.error.empty()) {
+					done.set_value();
+				} else {
+					const std::exception_ptr error = std::make_exception_ptr(std::runtime_error(file.error));
+					if (!first_error) {
+						first_error = error;
+					}
+					done.set_exception(error);
+				}
+			}
+		}
+
+		{
+			std::lock_guard lock{ m_mutex };
+			if (first_error && !m_error) {
+				m_error = first_error;
+			}
+			m_in_flight -= batch.size();
+		}
+		m_cv.notify_all();
+	}
+}
+
+void DiskWriter::write_batch(std::vector<FileWrite>& files) {
+	for (FileWrite& file : files) {
+		file.fd = ::open(file.filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if (file.fd < 0) {
+			file.error = errno_message("open", file.filepath, errno);
+		}
+	}
+
+	write_batch_io_uring(files);
+	write_batch_pwritev(files);
+
+	for (FileWrite& file : files) {
+		if (file.fd >= 0) {
+			::close(file.fd);
+		}
+	}
+}
+
+void DiskWriter::write_batch_pwritev(std::vector<FileWrite>& files) {
+	for (FileWrite& file : files) {
+		if ((file.fd < 0) || file.completed) {
+			continue;
+		}
+
+		size_t offset = 0;
+		while (offset < file.size()) {
+			// Data then tail, starting from the first byte not written yet
+			iovec iovs[2];
+			int nb_iovs = 0;
+			if (offset < file.data.size()) {
+				iovs[nb_iovs++] = iovec{ file.data.data() + offset, file.data.size() - offset };
+			}
+			const size_t tail_offset = offset - std::min(offset, file.data.size());
+			if (tail_offset < file.tail.size()) {
+				iovs[nb_iovs++] = iovec{ const_cast<uint8_t*>(file.tail.data()) + tail_offset, file.tail.size() - tail_offset };
+			}
+			const ssize_t written = ::pwritev(file.fd, iovs, nb_iovs, offset);
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				file.error = errno_message("write", file.filepath, errno);
+				break;
+			}
+			offset += static_cast<size_t>(written);
+		}
+
+		if (m_durable && file.error.empty() && (::fdatasync(file.fd) < 0)) {
+			file.error = errno_message("sync", file.filepath, errno);
+		}
+	}
+}
+
+// Files the ring could not complete are left to pwritev
+void DiskWriter::write_batch_io_uring(std::vector<FileWrite>& files) {
+#ifdef XR2000_HAS_IO_URING
+	// Data and tail of each file
+	std::vector<std::array<iovec, 2>> iovs(files.size());
+	const size_t files_per_submit = QueueDepth / 2;
+
+	for (size_t first = 0; (first < files.size()) && (m_ring != nullptr); first += files_per_submit) {
+		io_uring* ring = static_cast<io_uring*>(m_ring);
+		const size_t last = std::min(files.size(), first + files_per_submit);
+
+		int nb_sqes = 0;
+		for (size_t i = first; i < last; ++i) {
+			FileWrite& file = files[i];
+			if (file.fd < 0) {
+				continue;
+			}
+
+			iovs[i][0] = iovec{ file.data.data(), file.data.size() };
+			iovs[i][1] = iovec{ const_cast<uint8_t*>(file.tail.data()), file.tail.size() };
+			io_uring_sqe* sqe = io_uring_get_sqe(ring);
+			io_uring_prep_writev(sqe, file.fd, iovs[i].data(), file.tail.empty() ? 1 : 2, 0);
+			sqe->user_data = i << 1;
+			++file.pending_completions;
+			++nb_sqes;
+
+			if (m_durable) {
+				// Sync only runs once the write succeeded
+				sqe->flags |= IOSQE_IO_LINK;
+				io_uring_sqe* sync_sqe = io_uring_get_sqe(ring);
+				io_uring_prep_fsync(sync_sqe, file.fd, IORING_FSYNC_DATASYNC);
+				sync_sqe->user_data = (i << 1) | 1;
+				++file.pending_completions;
+				++nb_sqes;
+			}
+		}
+
+		if (nb_sqes == 0) {
+			continue;
+		}
+
+		// Requests left in the submission queue would run with the iovecs and fds of
+		// this batch during a later submit: on error or short submit the ring is dropped
+		const int submitted = io_uring_submit(ring);
+		bool ring_failed = (submitted != nb_sqes);
+
+		for (int i = 0; i < std::max(submitted, 0); ++i) {
+			io_uring_cqe* cqe = nullptr;
+			int status;
+			do {
+				status = io_uring_wait_cqe(ring, &cqe);
+			} while (status == -EINTR);
+			if (status < 0) {
+				ring_failed = true;
+				break;
+			}
+
+			FileWrite& file = files[cqe->user_data >> 1];
+			const bool is_sync = cqe->user_data & 1;
+			--file.pending_completions;
+			if (file.error.empty()) {
+				if (cqe->res < 0) {
+					file.error = errno_message(is_sync ? "sync" : "write", file.filepath, -cqe->res);
+				} else if (!is_sync && (static_cast<size_t>(cqe->res) != file.size())) {
+					file.error = "Error: Short write on " + file.filepath;
+				}
+			}
+			io_uring_cqe_seen(ring, cqe);
+		}
+
+		for (size_t i = first; i < last; ++i) {
+			FileWrite& file = files[i];
+			if (file.fd < 0) {
+				continue;
+			}
+			// A failed write is final, an unfinished one is written again by pwritev
+			file.completed = (file.pending_completions == 0) || !file.error.empty();
+		}
+
+		if (ring_failed) {
+			drop_ring();
+		}
+	}
+#else
+	(void)files;
+#endif
+}
@@ -0,0 +1,39 @@
+#include "Dispatcher.hpp"
+
+#include "TCPConnect.hpp"
+
+#include <stdexcept>
+
+void Dispatcher::on(PacketType type, Handler handler) {
+	m_handlers[index(type)] = std::move(handler);
+}
+
+Packet Dispatcher::wait_for(TCPConnect& connection, std::initializer_list<PacketType> expected) {
+	return wait_for(connection, mask(expected));
+}
+
+Packet Dispatcher::wait_for(TCPConnect& connection, uint32_t expected_mask, const Matcher& matches) {
+	while (true) {
+		std::optional<Packet> p = route(recv_packet(connection), expected_mask, matches);
+		if (p.has_value()) {
+			return std::move(*p);
+		}
+	}
+}
+
+std::optional<Packet> Dispatcher::route(Packet p, uint32_t expected_mask, const Matcher& matches) const {
+	const size_t i = index(p.type);
+	if ((expected_mask & (uint32_t{ 1 } << i)) && (!matches || matches(p))) {
+		return p;
+	}
+
+	const Handler& handler = m_handlers[i];
+	if (!handler) {
+		p.pprint();
+		throw std::runtime_error("Error: Unexpected packet type");
+	}
+
+	handler(p);
+
+	return std::nullopt;
+}
@@ -0,0 +1,144 @@
+#include "MailOutbox.hpp"
+
+#include "TCPConnect.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+
+void MailOutbox::push(OutgoingMail mail) {
+	m_pending.push_back(Entry{ std::move(mail), std::nullopt });
+}
+
+SendReport MailOutbox::send(TCPConnect& connection, Dispatcher& dispatcher, size_t window) {
+	window = std::clamp<size_t>(window, 1, MaxWindow);
+
+	// Mail index of each request id in flight
+	std::array<std::optional<size_t>, MaxWindow> in_flight;
+	std::vector<bool> sent(m_pending.size(), false);
+	SendReport report{ 0, 0 };
+
+	size_t next = 0;
+	size_t outstanding = 0;
+	uint8_t next_id = 0;
+	while (true) {
+		// Refill the window in a single write
+		std::vector<Packet> packets;
+		while ((outstanding < window) && (next < m_pending.size())) {
+			while (in_flight[next_id].has_value()) {
+				++next_id;
+			}
+			in_flight[next_id] = next;
+			packets.push_back(write_sendmail_packet(m_pending[next].mail, next_id));
+			++next_id;
+			++next;
+			++outstanding;
+		}
+		if (!packets.empty()) {
+			send_packets(connection, packets);
+		}
+
+		if (outstanding == 0) {
+			break;
+		}
+
+		const Packet p = dispatcher.wait_for(connection, { PacketType::Result });
+		if (!p.request_id.has_value() || !in_flight[*p.request_id].has_value()) {
+			throw std::runtime_error("Error: Result packet for an unknown SendMail request");
+		}
+
+		const size_t index = *in_flight[*p.request_id];
+		in_flight[*p.request_id].reset();
+		--outstanding;
+
+		const Result result = handle_result_packet(p);
+		if (result.success()) {
+			sent[index] = true;
+			++report.sent;
+		} else {
+			m_pending[index].last_result = result;
+			++report.failed;
+		}
+	}
+
+	// Only refused mails are left, in their original order
+	size_t kept = 0;
+	for (size_t i = 0; i < m_pending.size(); ++i) {
+		if (!sent[i]) {
+			m_pending[kept++] = std::move(m_pending[i]);
+		}
+	}
+	m_pending.resize(kept);
+
+	return report;
+}
+
+const std::vector<MailOutbox::Entry>& MailOutbox::pending() const {
+	return m_pending;
+}
+
+size_t MailOutbox::size() const {
+	return m_pending.size();
+}
+
+// Sequence of SendMail payloads, each one preceded by its little endian u32 size
+std::string MailOutbox::serialize() const {
+	std::string data;
+	for (const Entry& entry : m_pending) {
+		const std::vector<uint8_t> record = SendMailSchema::encode(entry.mail.recipient, entry.mail.content);
+		const std::vector<uint8_t> size = schema::Schema<schema::LE<uint32_t>>::encode(static_cast<uint32_t>(record.size()));
+		data.append(size.begin(), size.end());
+		data.append(record.begin(), record.end());
+	}
+
+	return data;
+}
+
+void MailOutbox::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::binary };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save outbox");
+	}
+
+	outfile << serialize();
+
+	outfile.close();
+}
+
+std::future<void> MailOutbox::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	return writer.write(std::move(filepath), serialize());
+}
+
+void MailOutbox::read_on_disk(std::string filepath) {
+	std::ifstream infile{ filepath, std::ios::binary };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read outbox");
+	}
+
+	const std::vector<uint8_t> data{ std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>() };
+	infile.close();
+
+	// Unlike a cache, losing mails silently is not an option
+	const std::span<const uint8_t> bytes{ data };
+	size_t offset = 0;
+	while (offset < bytes.size()) {
+		const auto size = schema::Schema<schema::LE<uint32_t>>::decode(bytes.subspan(offset, std::min<size_t>(4, bytes.size() - offset)));
+		if (!size.has_value() || (std::get<0>(*size) > bytes.size() - offset - 4)) {
+			throw std::runtime_error("Error: Corrupted outbox " + filepath);
+		}
+		offset += 4;
+		const size_t record_size = std::get<0>(*size);
+
+		auto record = SendMailSchema::decode(bytes.subspan(offset, record_size));
+		if (!record.has_value()) {
+			throw std::runtime_error("Error: Corrupted outbox " + filepath);
+		}
+		offset += record_size;
+
+		auto& [recipient, content] = *record;
+		push(OutgoingMail{ std::move(recipient), std::move(content) });
+	}
+}
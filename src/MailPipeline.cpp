@@ -0,0 +1,81 @@
+#include "MailPipeline.hpp"
+
+MailPipeline::MailPipeline(TranslateStage translate, PersistStage persist, size_t capacity)
+	: m_translate{ std::move(translate) }
+	, m_persist{ std::move(persist) }
+	, m_to_translate{ capacity }
+	, m_to_persist{ capacity }
+	, m_translated{ 0 }
+	, m_persisted{ 0 }
+{
+	m_translate_thread = std::thread{ &MailPipeline::run_translate, this };
+	m_persist_thread = std::thread{ &MailPipeline::run_persist, this };
+}
+
+MailPipeline::~MailPipeline() {
+	if (m_translate_thread.joinable()) {
+		m_to_translate.close();
+		m_translate_thread.join();
+		m_persist_thread.join();
+	}
+}
+
+void MailPipeline::push(Mail mail) {
+	m_to_translate.push(Job{ std::move(mail), std::nullopt });
+}
+
+std::vector<Mail> MailPipeline::finish() {
+	m_to_translate.close();
+	m_translate_thread.join();
+	m_persist_thread.join();
+
+	if (m_translate_error) {
+		std::rethrow_exception(m_translate_error);
+	}
+	if (m_persist_error) {
+		std::rethrow_exception(m_persist_error);
+	}
+
+	return std::move(m_done);
+}
+
+StageMetrics MailPipeline::translate_metrics() const {
+	return StageMetrics{ m_translated.load(std::memory_order_relaxed), m_to_translate.metrics() };
+}
+
+StageMetrics MailPipeline::persist_metrics() const {
+	return StageMetrics{ m_persisted.load(std::memory_order_relaxed), m_to_persist.metrics() };
+}
+
+// After an error a stage keeps draining its queue so upstream never blocks
+void MailPipeline::run_translate() {
+	while (std::optional<Job> job = m_to_translate.pop()) {
+		if (!m_translate_error) {
+			try {
+				job->translation = m_translate(job->mail);
+			} catch (...) {
+				m_translate_error = std::current_exception();
+			}
+		}
+
+		m_translated.fetch_add(1, std::memory_order_relaxed);
+		m_to_persist.push(std::move(*job));
+	}
+
+	m_to_persist.close();
+}
+
+void MailPipeline::run_persist() {
+	while (std::optional<Job> job = m_to_persist.pop()) {
+		if (!m_persist_error) {
+			try {
+				m_persist(job->mail, job->translation);
+			} catch (...) {
+				m_persist_error = std::current_exception();
+			}
+		}
+
+		m_persisted.fetch_add(1, std::memory_order_relaxed);
+		m_done.push_back(std::move(job->mail));
+	}
+}
@@ -0,0 +1,77 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+// O_TMPFILE when the filesystem supports it, a file unlinked right away otherwise
+int open_unnamed(const std::string& directory) {
+	const int fd = ::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+	if (fd >= 0) {
+		return fd;
+	}
+
+	std::string path = directory + "/xr2000_payload_XXXXXX";
+	const int named = ::mkostemp(path.data(), O_CLOEXEC);
+	if (named >= 0) {
+		::unlink(path.c_str());
+	}
+
+	return named;
+}
+
+}
+
+MappedFile::MappedFile(const std::string& directory, size_t size)
+	: m_fd{ -1 }
+	, m_data{ nullptr }
+	, m_size{ size }
+{
+	const std::string dir = directory.empty() ? std::filesystem::temp_directory_path().string() : directory;
+
+	m_fd = open_unnamed(dir);
+	if (m_fd < 0) {
+		throw std::runtime_error("Error: Could not create a temporary file in " + dir + ": " + std::strerror(errno));
+	}
+
+	if (m_size == 0) {
+		return;
+	}
+
+	if (::ftruncate(m_fd, static_cast<off_t>(m_size)) < 0) {
+		const int error = errno;
+		::close(m_fd);
+		throw std::runtime_error("Error: Could not grow a temporary file in " + dir + ": " + std::strerror(error));
+	}
+
+	void* data = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (data == MAP_FAILED) {
+		const int error = errno;
+		::close(m_fd);
+		throw std::runtime_error("Error: Could not map a temporary file: " + std::string(std::strerror(error)));
+	}
+	m_data = static_cast<uint8_t*>(data);
+}
+
+MappedFile::~MappedFile() {
+	if (m_data != nullptr) {
+		::munmap(m_data, m_size);
+	}
+	::close(m_fd);
+}
+
+std::span<uint8_t> MappedFile::bytes() {
+	return { m_data, m_size };
+}
+
+std::span<const uint8_t> MappedFile::bytes() const {
+	return { m_data, m_size };
+}
@@ -0,0 +1,258 @@
+#include "Packet.hpp"
+
+#include "ByteReader.hpp"
+#include "TCPConnect.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+
+std::ostream& operator<<(std::ostream& out, PacketType value) {
+	#define PROCESS_VAL(p) case(p): out << #p; break;
+	switch (value) {
+		PROCESS_VAL(PacketType::Help);
+		PROCESS_VAL(PacketType::Hello);
+		PROCESS_VAL(PacketType::Documentation);
+		PROCESS_VAL(PacketType::Register);
+		PROCESS_VAL(PacketType::Registered);
+		PROCESS_VAL(PacketType::Login);
+		PROCESS_VAL(PacketType::GetStatus);
+		PROCESS_VAL(PacketType::Status);
+		PROCESS_VAL(PacketType::GetMail);
+		PROCESS_VAL(PacketType::Mail);
+		PROCESS_VAL(PacketType::SendMail);
+		PROCESS_VAL(PacketType::Configure);
+		PROCESS_VAL(PacketType::Route);
+		PROCESS_VAL(PacketType::Translate);
+		PROCESS_VAL(PacketType::Translation);
+		PROCESS_VAL(PacketType::Result);
+	}
+	#undef PROCESS_VAL
+
+	return out;
+}
+
+std::span<const uint8_t> Packet::payload_view() const {
+	if (spilled_payload) {
+		return spilled_payload->bytes();
+	}
+
+	return payload;
+}
+
+void Packet::pprint() const {
+	std::cout << "Req ID present: " << std::boolalpha << request_id.has_value() << std::endl;
+	if (request_id.has_value()) {
+		std::cout << "Req ID: " << std::hex << *request_id << std::endl;
+	}
+	std::cout << "Type: " << type << " (0x" << std::hex << static_cast<int>(type) << ")" << std::endl;
+	std::cout << "Payload length: " << std::dec << payload_view().size() << std::endl;
+}
+
+// Convert lenght field length to actual length field
+uint8_t LFL_to_LF(uint8_t LFL) {
+	assert(LFL < 4);
+	if (LFL == 3) {
+		return 4;
+	}
+
+	return LFL;
+}
+
+// Convert lenght field to length field length
+uint8_t LF_to_LFL(uint8_t LF) {
+	assert((LF <=4) && (LF != 3));
+	if (LF == 4) {
+		return 3;
+	}
+
+	return LF;
+}
+
+template <typename T>
+T pop_and_get(std::queue<T>& collection) {
+	const T value = collection.front();
+	collection.pop();
+
+	return value;
+}
+
+// Receive until at least nb_bytes are pending, bytes of following packets may already be there
+void wait_bytes(TCPConnect& connection, size_t nb_bytes) {
+	while (connection.bytes().size() < nb_bytes) {
+		connection.recv();
+	}
+}
+
+size_t header_size(uint8_t first_byte) {
+	const uint8_t LFL = (0b11000000 & first_byte) >> 6;
+	const uint8_t request_id_present = (0b00100000 & first_byte) >> 5;
+
+	return 1 + 4 + request_id_present + LFL_to_LF(LFL);
+}
+
+std::optional<PacketHeader> parse_header(std::span<const uint8_t> bytes) {
+	ByteReader reader{ bytes };
+
+	uint8_t b;
+	if (!reader.read_le(b) || (bytes.size() != header_size(b)) || !reader.expect(Packet::Magic)) {
+		return std::nullopt;
+	}
+
+	PacketHeader header{ static_cast<PacketType>(0b00011111 & b), std::nullopt, 0 };
+	if (b & 0b00100000) {
+		uint8_t request_id;
+		if (!reader.read_le(request_id)) {
+			return std::nullopt;
+		}
+		header.request_id = request_id;
+	}
+
+	// Length field is 0, 1, 2 or 4 bytes long
+	if (!reader.read_le(header.payload_length, LFL_to_LF((0b11000000 & b) >> 6))) {
+		return std::nullopt;
+	}
+
+	return header;
+}
+
+Packet recv_packet(TCPConnect& connection) {
+	auto& bytes = connection.bytes();
+
+	uint8_t header_bytes[PacketHeader::MaxSize];
+	wait_bytes(connection, 1);
+	header_bytes[0] = pop_and_get(bytes);
+
+	const size_t size = header_size(header_bytes[0]);
+	wait_bytes(connection, size - 1);
+	for (size_t i = 1; i < size; ++i) {
+		header_bytes[i] = pop_and_get(bytes);
+	}
+
+	std::optional<PacketHeader> header = parse_header({ header_bytes, size });
+	if (!header.has_value()) {
+		throw std::runtime_error("Error: Invalid packet magic, stream out of sync");
+	}
+
+	const PacketType packet_type = header->type;
+	std::optional<uint8_t> request_id = header->request_id;
+	const uint32_t payload_length = header->payload_length;
+	if (payload_length == 0) { // No payload
+		return Packet{
+			packet_type,
+			request_id
+		};
+	}
+
+	if (payload_length > connection.options().spill_threshold) {
+		auto file = std::make_shared<MappedFile>(connection.options().spill_directory, payload_length);
+		const std::span<uint8_t> destination = file->bytes();
+
+		// Bytes already received, the rest goes straight from the socket to the file
+		size_t received = std::min<size_t>(bytes.size(), payload_length);
+		for (size_t i = 0; i < received; ++i) {
+			destination[i] = pop_and_get(bytes);
+		}
+		while (received < payload_length) {
+			received += connection.recv(destination.subspan(received));
+		}
+
+		return Packet{
+			packet_type,
+			std::move(request_id),
+			std::shared_ptr<const MappedFile>{ std::move(file) }
+		};
+	}
+
+	std::vector<uint8_t> payload;
+	payload.reserve(payload_length);
+	wait_bytes(connection, payload_length);
+
+	// TODO: Do a copy
+	for (size_t i = 0; i < payload_length; ++i) {
+		payload.push_back(pop_and_get(bytes));
+	}
+
+	return Packet{
+		packet_type,
+		std::move(request_id),
+		std::move(payload)
+	};
+}
+
+uint8_t compute_LF(uint32_t payload_size) {
+	if ((payload_size & 0xFFFF0000) > 0)
+		return 4;
+	if ((payload_size & 0x0000FF00) > 0)
+		return 2;
+	if (payload_size > 0)
+		return 1;
+	return 0;
+}
+
+size_t packet_size(const Packet& p) {
+	const uint32_t payload_size = p.payload.size();
+	return 1 + 4 + static_cast<size_t>(p.request_id.has_value()) + compute_LF(payload_size) + payload_size;
+}
+
+void serialize_packet(std::vector<char>& data, const Packet& p) {
+	const uint32_t payload_size = p.payload.size();
+	const uint8_t LF = compute_LF(payload_size);
+	const uint8_t LFL = LF_to_LFL(LF);
+	const bool request_id_present = p.request_id.has_value();
+
+	data.reserve(data.size() + packet_size(p));
+
+	// First byte: LFL + request id present + packet type
+	data.push_back(
+		(LFL << 6) | (static_cast<uint8_t>(request_id_present) << 5) | static_cast<uint8_t>(p.type)
+	);
+
+	// Magic number
+	data.push_back(Packet::Magic[0]);
+	data.push_back(Packet::Magic[1]);
+	data.push_back(Packet::Magic[2]);
+	data.push_back(Packet::Magic[3]);
+
+	// Add request id if present, after the magic as recv_packet expects it
+	if (request_id_present) {
+		data.push_back(p.request_id.value());
+	}
+
+	// Payload length (little endian)
+	for (size_t i = 0; i < LF; ++i) {
+		data.push_back(
+			static_cast<uint8_t>((payload_size >> (8*i)) & 0x000000FF)
+		);
+	}
+
+	// Payload
+	// TODO: replace by copy 
+	for (size_t i = 0; i < payload_size; ++i) {
+		data.push_back(p.payload[i]);
+	}
+}
+
+void send_packet(TCPConnect& connection, const Packet& p) {
+	std::vector<char> data;
+	serialize_packet(data, p);
+
+	connection.send(data);
+}
+
+void send_packets(TCPConnect& connection, const std::vector<Packet>& packets) {
+	size_t total_size = 0;
+	for (const Packet& p : packets) {
+		total_size += packet_size(p);
+	}
+
+	std::vector<char> data;
+	data.reserve(total_size);
+	for (const Packet& p : packets) {
+		serialize_packet(data, p);
+	}
+
+	connection.send(data);
+}
@@ -0,0 +1,160 @@
+#include "PhraseTranslator.hpp"
+
+#include "StringProcess.hpp"
+#include "Tokenizer.hpp"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+
+PhraseTranslator::PhraseTranslator(const Dictionnary& dict)
+	: m_nb_phrases{ 0 }
+{
+	std::vector<std::pair<std::string_view, std::string_view>> entries;
+	entries.reserve(dict.size());
+	dict.for_each([&entries](std::string_view key, std::string_view value) {
+		entries.emplace_back(key, value);
+	});
+
+	build(entries);
+}
+
+PhraseTranslator::PhraseTranslator(const std::unordered_map<std::string, std::string>& mapping)
+	: m_nb_phrases{ 0 }
+{
+	build(std::vector<std::pair<std::string_view, std::string_view>>(mapping.begin(), mapping.end()));
+}
+
+void PhraseTranslator::build(const std::vector<std::pair<std::string_view, std::string_view>>& entries) {
+	struct BuildNode {
+		std::map<uint8_t, uint32_t> children;
+		uint32_t value = NoValue;
+	};
+
+	std::vector<BuildNode> trie(1);
+	for (const auto& [key, value] : entries) {
+		if (key.empty()) {
+			continue;
+		}
+
+		uint32_t node = 0;
+		for (unsigned char c : key) {
+			const auto it = trie[node].children.find(c);
+			if (it != trie[node].children.end()) {
+				node = it->second;
+				continue;
+			}
+
+			const uint32_t id = static_cast<uint32_t>(trie.size());
+			trie[node].children[c] = id;
+			trie.emplace_back();
+			node = id;
+		}
+
+		trie[node].value = static_cast<uint32_t>(m_values.size());
+		m_values.emplace_back(value);
+		m_nb_phrases += std::any_of(key.begin(), key.end(), is_splitter);
+	}
+
+	// Flatten breadth first so that the top of the trie shares cache lines
+	std::vector<uint32_t> new_id(trie.size());
+	std::vector<uint32_t> order;
+	order.reserve(trie.size());
+	std::queue<uint32_t> pending;
+	pending.push(0);
+	while (!pending.empty()) {
+		const uint32_t old = pending.front();
+		pending.pop();
+		new_id[old] = static_cast<uint32_t>(order.size());
+		order.push_back(old);
+		for (const auto& [byte, target] : trie[old].children) {
+			pending.push(target);
+		}
+	}
+
+	m_nodes.reserve(trie.size());
+	m_edge_bytes.reserve(trie.size() - 1);
+	m_edge_targets.reserve(trie.size() - 1);
+	for (uint32_t old : order) {
+		const BuildNode& node = trie[old];
+		m_nodes.push_back(Node{
+			static_cast<uint32_t>(m_edge_bytes.size()),
+			static_cast<uint32_t>(node.children.size()),
+			node.value
+		});
+		for (const auto& [byte, target] : node.children) {
+			m_edge_bytes.push_back(byte);
+			m_edge_targets.push_back(new_id[target]);
+		}
+	}
+}
+
+uint32_t PhraseTranslator::child(uint32_t node, uint8_t byte) const {
+	const Node& n = m_nodes[node];
+	const auto first = m_edge_bytes.begin() + n.first_edge;
+	const auto last = first + n.nb_edges;
+
+	const auto it = std::lower_bound(first, last, byte);
+	if ((it == last) || (*it != byte)) {
+		return 0;
+	}
+
+	return m_edge_targets[it - m_edge_bytes.begin()];
+}
+
+std::string PhraseTranslator::translate(std::string_view original) const {
+	const std::string text = default_tokenizer().fold(original);
+
+	std::string translated;
+	translated.reserve(text.size());
+
+	const size_t length = text.size();
+	size_t i = 0;
+	while (i < length) {
+		const unsigned char c = text[i];
+		if (is_splitter(c)) {
+			translated += c;
+			++i;
+			continue;
+		}
+
+		// Longest key from this word start that also ends a word
+		uint32_t node = 0;
+		uint32_t best_value = NoValue;
+		size_t best_end = i;
+		for (size_t j = i; j < length; ++j) {
+			node = child(node, static_cast<uint8_t>(text[j]));
+			if (node == 0) {
+				break;
+			}
+
+			const bool word_end = (j + 1 == length) || is_splitter(text[j + 1]);
+			if ((m_nodes[node].value != NoValue) && word_end) {
+				best_value = m_nodes[node].value;
+				best_end = j + 1;
+			}
+		}
+
+		if (best_value != NoValue) {
+			translated += m_values[best_value];
+			i = best_end;
+			continue;
+		}
+
+		// Unknown word is kept
+		while ((i < length) && !is_splitter(text[i])) {
+			translated += text[i];
+			++i;
+		}
+	}
+
+	return translated;
+}
+
+size_t PhraseTranslator::size() const {
+	return m_values.size();
+}
+
+size_t PhraseTranslator::nb_phrases() const {
+	return m_nb_phrases;
+}
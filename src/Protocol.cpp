@@ -0,0 +1,489 @@
+#include "Protocol.hpp"
+
+#include "PhraseTranslator.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+// Everything written before the content
+std::string mail_header(const Mail& mail) {
+	std::ostringstream oss;
+	oss << "Mail n°" << mail.id << "\n";
+	oss << "Sent by " << mail.sender_username << " at " << mail.timestamp << "\n";
+	oss << "Content:" << "\n";
+
+	return oss.str();
+}
+
+// Phrase translator of the last dictionnary used, rebuilt only when its generation changed.
+// One per thread, mails may be translated by the pipeline
+const PhraseTranslator& cached_translator(const Dictionnary& dict) {
+	thread_local std::optional<PhraseTranslator> translator;
+	thread_local uint64_t translator_generation = 0;
+
+	if (!translator.has_value() || (translator_generation != dict.generation())) {
+		translator.emplace(dict);
+		translator_generation = dict.generation();
+	}
+
+	return *translator;
+}
+
+}
+
+void Hello::pprint() const {
+	std::cout << "Protocol version: " << static_cast<int>(protocol_version) << std::endl;
+	std::cout << "Hostname: " << hostname << std::endl;
+	std::cout << "Instruction: " << instruction << std::endl;
+}
+
+bool ServerInfos::is_current(const Hello& current) const {
+	const auto fields = HelloSchema::decode(hello);
+	return fields.has_value() && (std::get<0>(*fields) == current.protocol_version);
+}
+
+void ServerInfos::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::binary };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save server infos");
+	}
+
+	const std::vector<uint8_t> data = ServerInfosSchema::encode(hello, documentation);
+	outfile.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+	outfile.close();
+}
+
+std::future<void> ServerInfos::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	const std::vector<uint8_t> data = ServerInfosSchema::encode(hello, documentation);
+	return writer.write(std::move(filepath), std::string(data.begin(), data.end()));
+}
+
+std::future<void> ServerInfos::save_on_disk(DiskWriter& writer, std::string filepath, const Packet& hello, const Packet& documentation) {
+	const std::span<const uint8_t> hello_payload = hello.payload_view();
+	const std::span<const uint8_t> doc_payload = documentation.payload_view();
+	if ((hello_payload.size() > std::numeric_limits<uint32_t>::max()) || (doc_payload.size() > std::numeric_limits<uint32_t>::max())) {
+		throw std::runtime_error("Error: Server infos too long for their length prefix");
+	}
+
+	// ServerInfosSchema layout, the documentation bytes being the tail of the file
+	std::string head(2*sizeof(uint32_t) + hello_payload.size(), '\0');
+	uint8_t* out = reinterpret_cast<uint8_t*>(head.data());
+	out = schema::LE<uint32_t>::write(out, static_cast<uint32_t>(hello_payload.size()));
+	if (!hello_payload.empty()) {
+		std::memcpy(out, hello_payload.data(), hello_payload.size());
+	}
+	schema::LE<uint32_t>::write(out + hello_payload.size(), static_cast<uint32_t>(doc_payload.size()));
+
+	if (documentation.spilled_payload) {
+		return writer.write(std::move(filepath), std::move(head), doc_payload, documentation.spilled_payload);
+	}
+	head.append(reinterpret_cast<const char*>(doc_payload.data()), doc_payload.size());
+	return writer.write(std::move(filepath), std::move(head));
+}
+
+void ServerInfos::read_on_disk(std::string filepath) {
+	std::ifstream infile{ filepath, std::ios::binary };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read server infos");
+	}
+
+	// ServerInfosSchema layout: only the lengths and the hello are read
+	infile.seekg(0, std::ios::end);
+	const uint64_t file_size = static_cast<uint64_t>(infile.tellg());
+	infile.seekg(0, std::ios::beg);
+
+	uint8_t length_bytes[sizeof(uint32_t)];
+	const auto read_length = [&infile, &length_bytes]() -> std::optional<uint32_t> {
+		if (!infile.read(reinterpret_cast<char*>(length_bytes), sizeof(length_bytes))) {
+			return std::nullopt;
+		}
+		const auto length = schema::Schema<schema::LE<uint32_t>>::decode(length_bytes);
+		return std::get<0>(*length);
+	};
+
+	// A corrupted cache is simply ignored
+	const std::optional<uint32_t> hello_length = read_length();
+	if (!hello_length.has_value() || (*hello_length > file_size - sizeof(uint32_t))) {
+		return;
+	}
+	std::vector<uint8_t> hello_bytes(*hello_length);
+	if (!infile.read(reinterpret_cast<char*>(hello_bytes.data()), hello_bytes.size())) {
+		return;
+	}
+	const std::optional<uint32_t> doc_length = read_length();
+	if (!doc_length.has_value() || (file_size != 2*sizeof(uint32_t) + *hello_length + *doc_length)) {
+		return;
+	}
+
+	hello = std::move(hello_bytes);
+	documentation.clear();
+}
+
+void CredentialInfos::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::binary };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save credential");
+	}
+
+	const std::vector<uint8_t> data = CredentialSchema::encode(username, password);
+	outfile.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+	outfile.close();
+}
+
+std::future<void> CredentialInfos::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	const std::vector<uint8_t> data = CredentialSchema::encode(username, password);
+	return writer.write(std::move(filepath), std::string(data.begin(), data.end()));
+}
+
+void CredentialInfos::read_on_disk(std::string filepath) {
+	std::ifstream infile{ filepath, std::ios::binary };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read credential");
+	}
+
+	uint8_t username_length;
+	infile.read(reinterpret_cast<char*>(&username_length), sizeof(username_length));
+	username.resize(username_length);
+	infile.read(reinterpret_cast<char*>(username.data()), username_length);
+
+	uint8_t password_length;
+	infile.read(reinterpret_cast<char*>(&password_length), sizeof(password_length));
+	password.resize(password_length);
+	infile.read(reinterpret_cast<char*>(password.data()), password_length);
+
+	infile.close();
+}
+
+void CredentialInfos::pprint() const {
+	std::cout << "Credential:" << std::endl;
+	std::cout << "\tUsername: 0x" << std::hex;
+	for(auto v : username) {
+		std::cout << v;
+	}
+	std::cout << std::dec << std::endl;
+
+	std::cout << "\tPassword: 0x" << std::hex;
+	for(auto v : password) {
+		std::cout << v;
+	}
+	std::cout << std::dec << std::endl;
+}
+
+bool Result::success() const {
+	return code == 0x00;
+}
+
+bool Result::error() const {
+	return !success();
+}
+
+std::string Result::to_string() const {
+	switch (code) {
+		case 0x00: return "Success";
+		case 0x01: return "Already authenticated";
+		case 0x02: return "Not autheticated";
+		case 0x03: return "Invalid credential";
+		case 0x04: return "Not authorized for tranceive";
+		case 0x11: return "Registration rate limit";
+		case 0x12: return "Translation limiting";
+		case 0x20: return "Tranceiver malfunction";
+		case 0x21: return "Invalid config";
+		case 0x40: return "Mail not found";
+		case 0x50: return "Translation not found";
+		default: return "Unknow result code";
+	}
+}
+
+void Result::pprint() const {
+	std::cout << "Result:" << std::endl;
+	std::cout << "\t" << to_string() << " (0x" << std::hex << static_cast<int>(code) << std::dec << ")" << std::endl;
+}
+
+void Status::pprint() const {
+	std::cout << "Status:" << std::endl;
+	std::cout << "\tConnected since " << connection_time << "s" << std::endl;
+	std::cout << "\tAuthenticated: " << std::boolalpha << authenticated << std::dec << std::endl;
+	std::cout << "\tAuthorized: " << std::boolalpha << authorized << std::dec << std::endl;
+	std::cout << "\tConfigured: " << std::boolalpha << configured << std::dec << std::endl;
+	if (nb_mails.has_value()) {
+		std::cout << "\tNb mails: " << nb_mails.value() << std::endl;
+	}
+}
+
+void Configuration::read_on_disk(const std::string& filepath) {
+	std::ifstream infile{ filepath };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read configuration");
+	}
+
+	// Prevent reading value as char
+	uint16_t temp_modulation = 0;
+	infile >> frequency;
+	infile >> baudrate;
+	infile >> temp_modulation;
+
+	modulation = static_cast<uint8_t>(temp_modulation);
+
+	infile.close();
+}
+
+void Configuration::pprint() {
+	std::cout << "Configuration: " << std::endl;
+	std::cout << "\tFrequency: " << frequency << std::endl;
+	std::cout << "\tBaudrate: " << baudrate << std::endl;
+	std::cout << "\tModulation: ";
+	switch (modulation) {
+		case 0x00: std::cout << "AM"; break;
+		case 0x01: std::cout << "FM"; break;
+		case 0x02: std::cout << "PM"; break;
+		case 0x03: std::cout << "BPSK"; break;
+		default: std::cout << "Unknown (0x" << std::hex << static_cast<int>(modulation) << std::dec << ")";
+	}
+	std::cout << std::endl;
+}
+
+void Mail::pprint() const {
+	std::cout << "Mail n° " << id << std::endl;
+	std::cout << "\tSent by " << sender_username << " at " << timestamp << std::endl;
+	std::cout << "\tContent: " << text() << std::endl;
+}
+
+void Mail::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::out };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save mail");
+	}
+
+	outfile << mail_header(*this) << text();
+
+	outfile.close();
+}
+
+std::future<void> Mail::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	// A spilled content is written from its mapping
+	if (spilled_payload) {
+		const std::span<const uint8_t> tail{ reinterpret_cast<const uint8_t*>(spilled_content.data()), spilled_content.size() };
+		return writer.write(std::move(filepath), mail_header(*this), tail, spilled_payload);
+	}
+
+	return writer.write(std::move(filepath), mail_header(*this) + content);
+}
+
+std::string_view Mail::text() const {
+	return spilled_payload ? spilled_content : std::string_view{ content };
+}
+
+void Mail::set_text(std::string text) {
+	content = std::move(text);
+	spilled_payload = nullptr;
+	spilled_content = {};
+}
+
+void Mail::translate(const Dictionnary& dict) {
+	set_text(cached_translator(dict).translate(text()));
+}
+
+std::optional<Hello> decode_hello(const Packet& p) {
+	assert(p.type == PacketType::Hello);
+
+	auto fields = HelloSchema::decode(p.payload_view());
+	if (!fields.has_value()) {
+		return std::nullopt;
+	}
+	auto& [protocol_version, hostname, instr] = *fields;
+
+	return Hello {
+		protocol_version,
+		std::move(hostname),
+		std::move(instr)
+	};
+}
+
+std::optional<CredentialInfos> decode_registered(const Packet& p) {
+	assert(p.type == PacketType::Registered);
+
+	auto fields = CredentialSchema::decode(p.payload_view());
+	if (!fields.has_value()) {
+		return std::nullopt;
+	}
+	auto& [username, password] = *fields;
+
+	return CredentialInfos {
+		std::move(username),
+		std::move(password)
+	};
+}
+
+std::optional<Result> decode_result(const Packet& p) {
+	assert(p.type == PacketType::Result);
+
+	const auto fields = ResultSchema::decode(p.payload_view());
+	if (!fields.has_value()) {
+		return std::nullopt;
+	}
+	const auto [code] = *fields;
+
+	return Result{ code };
+}
+
+std::optional<Status> decode_status(const Packet& p) {
+	assert(p.type == PacketType::Status);
+
+	const auto fields = StatusSchema::decode(p.payload_view());
+	if (!fields.has_value()) {
+		return std::nullopt;
+	}
+	const auto [nb_mails_v, connection_time, flags] = *fields;
+
+	const std::optional<uint32_t> nb_mail = (nb_mails_v == 0xffffffff)
+	                                      ? std::nullopt
+	                                      : std::make_optional(nb_mails_v);
+
+	const bool authenticated = !(flags & 0b00000100);
+	const bool authorized = !(flags & 0b00000010);
+	const bool configured = !(flags & 0b00000001);
+
+	return Status {
+		nb_mail,
+		connection_time,
+		authenticated,
+		authorized,
+		configured
+	};
+}
+
+std::optional<std::string> decode_translation(const Packet& p) {
+	assert(p.type == PacketType::Translation);
+
+	auto fields = TranslationSchema::decode(p.payload_view());
+	if (!fields.has_value()) {
+		return std::nullopt;
+	}
+
+	return std::move(std::get<0>(*fields));
+}
+
+std::optional<Mail> decode_mail(const Packet& p) {
+	assert(p.type == PacketType::Mail);
+
+	// The content is a view into the payload
+	auto fields = MailViewSchema::decode(p.payload_view());
+	if (!fields.has_value()) {
+		return std::nullopt;
+	}
+	auto& [id, timestamp, username, content] = *fields;
+
+	// A spilled content stays in its mapping, a small one is copied
+	if (p.spilled_payload) {
+		return Mail { id, timestamp, std::move(username), {}, p.spilled_payload, content };
+	}
+	return Mail { id, timestamp, std::move(username), std::string{ content } };
+}
+
+std::optional<uint32_t> decode_mail_id(const Packet& p) {
+	assert(p.type == PacketType::Mail);
+
+	ByteReader reader{ p.payload_view() };
+	uint32_t id;
+	if (!reader.read_le(id)) {
+		return std::nullopt;
+	}
+
+	return id;
+}
+
+Hello handle_hello_packet(const Packet& p) {
+	std::optional<Hello> decoded = decode_hello(p);
+	if (!decoded.has_value()) {
+		throw std::runtime_error("Error: Malformed Hello packet");
+	}
+
+	return std::move(*decoded);
+}
+
+void handle_doc_packet(const Packet& p) {
+	assert(p.type == PacketType::Documentation);
+
+	const std::span<const uint8_t> payload = p.payload_view();
+	const std::string_view doc{
+		reinterpret_cast<const char*>(payload.data()),
+		payload.size()
+	};
+	std::cout << doc << std::endl;
+}
+
+CredentialInfos handle_registered_packet(const Packet& p) {
+	std::optional<CredentialInfos> decoded = decode_registered(p);
+	if (!decoded.has_value()) {
+		throw std::runtime_error("Error: Malformed Registered packet");
+	}
+
+	return std::move(*decoded);
+}
+
+Result handle_result_packet(const Packet& p) {
+	std::optional<Result> decoded = decode_result(p);
+	if (!decoded.has_value()) {
+		throw std::runtime_error("Error: Malformed Result packet");
+	}
+
+	return std::move(*decoded);
+}
+
+Status handle_status_packet(const Packet& p) {
+	std::optional<Status> decoded = decode_status(p);
+	if (!decoded.has_value()) {
+		throw std::runtime_error("Error: Malformed Status packet");
+	}
+
+	return std::move(*decoded);
+}
+
+std::string handle_translation_packet(const Packet& p) {
+	std::optional<std::string> decoded = decode_translation(p);
+	if (!decoded.has_value()) {
+		throw std::runtime_error("Error: Malformed Translation packet");
+	}
+
+	return std::move(*decoded);
+}
+
+Mail handle_mail_packet(const Packet& p) {
+	std::optional<Mail> decoded = decode_mail(p);
+	if (!decoded.has_value()) {
+		throw std::runtime_error("Error: Malformed Mail packet");
+	}
+
+	return std::move(*decoded);
+}
+
+Packet write_login_packet(const CredentialInfos& credential) {
+	return Packet { PacketType::Login, CredentialSchema::encode(credential.username, credential.password) };
+}
+
+Packet write_configuration_packet(const Configuration& config) {
+	return Packet { PacketType::Configure, ConfigurationSchema::encode(config.frequency, config.baudrate, config.modulation) };
+}
+
+Packet write_translate_packet(const std::string& word) {
+	return Packet{ PacketType::Translate, TranslateSchema::encode(word) };
+}
+
+Packet write_getmail_packet(uint32_t mail_id) {
+	return Packet { PacketType::GetMail, GetMailSchema::encode(mail_id) };
+}
+
+Packet write_sendmail_packet(const OutgoingMail& mail, std::optional<uint8_t> request_id) {
+	return Packet { PacketType::SendMail, request_id, SendMailSchema::encode(mail.recipient, mail.content) };
+}
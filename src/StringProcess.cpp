@@ -1,12 +1,22 @@
 #include "StringProcess.hpp"
 
+#include "Tokenizer.hpp"
+
 #include <algorithm>
-#include <sstream>
+#include <optional>
 
 bool is_alpha(const std::string& str) {
-	return std::find_if(str.begin(), str.end(), [](char c) {
-		return !(std::isalpha(c));
-	}) == str.end();
+	size_t i = 0;
+	while (i < str.size()) {
+		size_t length = 1;
+		const std::optional<char32_t> cp = utf8::decode(str, i, length);
+		if (!cp.has_value() || !utf8::is_letter(*cp)) {
+			return false;
+		}
+		i += length;
+	}
+
+	return true;
 }
 
 bool has_alphanumeric(const std::string& str) {
@@ -16,71 +26,45 @@ bool has_alphanumeric(const std::string& str) {
 }
 
 bool is_splitter(unsigned char c) {
-	return (c == ',') || (c == '.') || (c == ':') || (c == '-') || (c == ' ') || (c == '\n') || (c == '(') || (c == ')');
+	return default_tokenizer().is_splitter(c);
 }
 
-std::vector<std::string> get_unique_words(const std::string& text) {
-	std::string cleaned = text;
+std::unordered_map<std::string, size_t> count_words(std::string_view text) {
+	// Whitespaces also end words
+	static const Tokenizer tokenizer{ std::string(Tokenizer::DefaultSplitters) + "\t\v\f\r" };
 
-	// Remove useless characters
-	for(auto& c: cleaned) {
-		if (is_splitter(c)) {
-			c = ' ';
-		} else if (std::isupper(c)) {
-			c = std::tolower(c);
-		}
-	}
+	std::unordered_map<std::string, size_t> counts;
+	tokenizer.for_each_word(text, [&counts](const std::string& word) {
+		++counts[word];
+	});
+
+	return counts;
+}
+
+std::vector<std::string> get_unique_words(std::string_view text) {
+	const std::unordered_map<std::string, size_t> counts = count_words(text);
 
 	std::vector<std::string> words;
-	std::istringstream iss(cleaned);
-	std::string word;
-    while (iss >> word) {
-        words.push_back(word);
-    }
-
-	words.erase(
-		std::remove_if(words.begin(), words.end(), [](const std::string& w) {
-			return !is_alpha(w);
-		}),
-		words.end()
-	);
+	words.reserve(counts.size());
+	for (const auto& [word, count] : counts) {
+		words.push_back(word);
+	}
 
 	std::sort(words.begin(), words.end());
 
-	// Keep unique words
-	const auto it = std::unique(words.begin(), words.end());
-	words.resize(std::distance(words.begin(), it));
-
-    return words;
+	return words;
 }
 
 std::string translate(const std::string& text, const std::unordered_map<std::string, std::string>& mapping) {
-	std::ostringstream oss;
-
-	std::string word = "";
-	for (unsigned char c : text) {
-		if (is_splitter(c)) {
-			if (word != "") { // Pending word to translate
-				if (mapping.contains(word)) {
-					oss << mapping.at(word);
-				} else {
-					oss << word;
-				}
-				word = "";
-			}
-			oss << c;
-		} else {
-			word += std::tolower(c);
-		}
-	}
+	std::string translated;
+	translated.reserve(text.size());
 
-	// Empty word
-	if (mapping.contains(word)) {
-		oss << mapping.at(word);
-	} else {
-		oss << word;
-	}
+	default_tokenizer().scan(text, [&translated](char c) {
+		translated += c;
+	}, [&translated, &mapping](const std::string& word, bool) {
+		const auto it = mapping.find(word);
+		translated += (it != mapping.end()) ? it->second : word;
+	});
 
-	return oss.str();
+	return translated;
 }
-
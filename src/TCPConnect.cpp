@@ -3,50 +3,263 @@
 #include <stdexcept>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <cstring>
+#include <cerrno>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
 
 #include <iostream>
 
-TCPConnect::TCPConnect(std::string server_adress, std::string port_str)
-	: sock{ -1 }
-	, m_server_adress{ std::move(server_adress) }
-	, m_port_str{ std::move(port_str) }
-{
+using tcp_detail::ResolvedAdress;
+
+namespace {
+
+std::mutex cache_mutex;
+std::map<std::string, std::vector<ResolvedAdress>> adress_cache;
+
+// Resolve once per host and port
+std::vector<ResolvedAdress> resolve(const std::string& server_adress, const std::string& port_str) {
+	const std::string key = server_adress + ":" + port_str;
+	{
+		std::lock_guard lock{ cache_mutex };
+		const auto it = adress_cache.find(key);
+		if (it != adress_cache.end()) {
+			return it->second;
+		}
+	}
+
 	struct addrinfo hints, *server_info, *p;
 
 	std::memset(&hints, 0, sizeof(hints));
 	hints.ai_family = AF_UNSPEC;
 	hints.ai_socktype = SOCK_STREAM;
 	
-	int status = getaddrinfo(m_server_adress.c_str(), m_port_str.c_str(), &hints, &server_info);
+	int status = getaddrinfo(server_adress.c_str(), port_str.c_str(), &hints, &server_info);
 	if (status != 0) {
 		throw std::runtime_error("Error: getaddrinfo failed: " + std::string{gai_strerror(status)} );
 	}
-	
+
+	std::vector<ResolvedAdress> resolved;
 	for(p = server_info; p != NULL; p = p->ai_next) {
-		sock = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
-		if (sock < 0) {
+		ResolvedAdress adress{ p->ai_family, p->ai_socktype, p->ai_protocol, {}, p->ai_addrlen };
+		std::memcpy(&adress.addr, p->ai_addr, p->ai_addrlen);
+		resolved.push_back(adress);
+	}
+	freeaddrinfo(server_info);
+
+	const std::vector<ResolvedAdress> adresses = tcp_detail::interleave_families(resolved);
+
+	std::lock_guard lock{ cache_mutex };
+	adress_cache[key] = adresses;
+
+	return adresses;
+}
+
+void forget(const std::string& server_adress, const std::string& port_str) {
+	std::lock_guard lock{ cache_mutex };
+	adress_cache.erase(server_adress + ":" + port_str);
+}
+
+void apply_options(int fd, const TCPOptions& options) {
+	if (options.no_delay) {
+		const int flag = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+	}
+	// Buffer sizes must be set before connect to be used for the window scale
+	if (options.recv_buffer_size.has_value()) {
+		setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &*options.recv_buffer_size, sizeof(int));
+	}
+	if (options.send_buffer_size.has_value()) {
+		setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &*options.send_buffer_size, sizeof(int));
+	}
+}
+
+struct Attempt {
+	int fd;
+	std::chrono::steady_clock::time_point deadline;
+};
+
+// Start a non blocking connect, return -1 if it failed right away
+int start_attempt(const ResolvedAdress& adress, const TCPOptions& options, bool& connected) {
+	const int fd = socket(adress.family, adress.socktype | SOCK_NONBLOCK, adress.protocol);
+	if (fd < 0) {
+		return -1;
+	}
+
+	apply_options(fd, options);
+
+	connected = false;
+	if (connect(fd, reinterpret_cast<const sockaddr*>(&adress.addr), adress.addr_length) == 0) {
+		connected = true;
+	} else if (errno != EINPROGRESS) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+}
+
+std::vector<ResolvedAdress> tcp_detail::interleave_families(const std::vector<ResolvedAdress>& resolved) {
+	std::vector<ResolvedAdress> ipv6, ipv4;
+	for (const ResolvedAdress& adress : resolved) {
+		(adress.family == AF_INET6 ? ipv6 : ipv4).push_back(adress);
+	}
+
+	std::vector<ResolvedAdress> adresses;
+	adresses.reserve(resolved.size());
+	for (size_t i = 0; i < std::max(ipv6.size(), ipv4.size()); ++i) {
+		if (i < ipv6.size()) {
+			adresses.push_back(ipv6[i]);
+		}
+		if (i < ipv4.size()) {
+			adresses.push_back(ipv4[i]);
+		}
+	}
+
+	return adresses;
+}
+
+int tcp_detail::connect_any(const std::vector<ResolvedAdress>& adresses, const TCPOptions& options) {
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<Attempt> attempts;
+	size_t next = 0;
+	Clock::time_point next_start = Clock::now();
+	int sock = -1;
+
+	while (sock == -1) {
+		Clock::time_point now = Clock::now();
+
+		// Start next attempt when its turn comes, or right away if nothing is pending
+		if ((next < adresses.size()) && (attempts.empty() || (now >= next_start))) {
+			bool connected = false;
+			const int fd = start_attempt(adresses[next++], options, connected);
+			if (connected) {
+				sock = fd;
+				break;
+			}
+			if (fd >= 0) {
+				attempts.push_back(Attempt{ fd, now + options.attempt_timeout });
+				next_start = now + options.attempt_delay;
+			} else {
+				// Failed at once, the next adress need not wait behind it
+				next_start = now;
+			}
 			continue;
 		}
-	
-		if (connect(sock, p->ai_addr, p->ai_addrlen) < 0) {
-			close(sock);
-			sock = -1;
+
+		// Drop timed out attempts
+		std::erase_if(attempts, [now](const Attempt& a) {
+			if (now >= a.deadline) {
+				close(a.fd);
+				return true;
+			}
+			return false;
+		});
+
+		if (attempts.empty()) {
+			if (next >= adresses.size()) {
+				break;
+			}
 			continue;
 		}
-	
-		break;
+
+		Clock::time_point wake_up = std::min_element(attempts.begin(), attempts.end(), [](const Attempt& a, const Attempt& b) {
+			return a.deadline < b.deadline;
+		})->deadline;
+		if (next < adresses.size()) {
+			wake_up = std::min(wake_up, next_start);
+		}
+		const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(wake_up - now);
+
+		std::vector<pollfd> fds;
+		fds.reserve(attempts.size());
+		for (const Attempt& a : attempts) {
+			fds.push_back(pollfd{ a.fd, POLLOUT, 0 });
+		}
+
+		if (poll(fds.data(), fds.size(), std::max<int>(timeout.count(), 0)) <= 0) {
+			continue;
+		}
+
+		for (size_t i = 0; i < fds.size(); ++i) {
+			if (fds[i].revents == 0) {
+				continue;
+			}
+
+			int error = 0;
+			socklen_t length = sizeof(error);
+			getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, &error, &length);
+			if ((error == 0) && (sock == -1)) {
+				sock = fds[i].fd;
+			} else {
+				close(fds[i].fd);
+				if (error != 0) {
+					// Refused, hand its turn over to the next adress
+					next_start = Clock::now();
+				}
+			}
+			attempts[i].fd = -1;
+		}
+		std::erase_if(attempts, [](const Attempt& a) { return a.fd == -1; });
 	}
-	
+
+	// Losers of the race
+	for (const Attempt& a : attempts) {
+		close(a.fd);
+	}
+
+	if (sock != -1) {
+		// Back to blocking mode for send/recv
+		fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+	}
+
+	return sock;
+}
+
+TCPConnect::TCPConnect(std::string server_adress, std::string port_str, TCPOptions options)
+	: sock{ -1 }
+	, m_server_adress{ std::move(server_adress) }
+	, m_port_str{ std::move(port_str) }
+	, m_options{ std::move(options) }
+{
+	sock = tcp_detail::connect_any(resolve(m_server_adress, m_port_str), m_options);
 	if (sock == -1) {
-		freeaddrinfo(server_info);
+		// Adresses may have changed since they were cached
+		forget(m_server_adress, m_port_str);
 		throw std::runtime_error("Error: Failed to connect to any resolved adress");
 	}
 	
 	std::cout << "Successfully connected to " << m_server_adress << ":" << m_port_str << std::endl;
-	freeaddrinfo(server_info);
+}
+
+TCPConnect::~TCPConnect() {
+	if (sock != -1) {
+		close(sock);
+	}
+}
+
+void TCPConnect::clear_address_cache() {
+	std::lock_guard lock{ cache_mutex };
+	adress_cache.clear();
+}
+
+const TCPOptions& TCPConnect::options() const {
+	return m_options;
+}
+
+int TCPConnect::native_handle() const {
+	return sock;
 }
 
 std::queue<uint8_t>& TCPConnect::bytes() {
@@ -77,3 +290,12 @@ size_t TCPConnect::recv() {
 
 	return static_cast<size_t>(bytes);
 }
+
+size_t TCPConnect::recv(std::span<uint8_t> buffer) {
+	const ssize_t bytes = ::recv(sock, buffer.data(), buffer.size(), 0);
+	if (bytes <= 0) {
+		throw std::runtime_error("Error: Could not receive from the server");
+	}
+
+	return static_cast<size_t>(bytes);
+}
@@ -0,0 +1,180 @@
+#include "Tokenizer.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+struct Range {
+	char32_t first;
+	char32_t last;
+};
+
+// Sorted, non ASCII
+constexpr Range LetterRanges[] = {
+	{ 0x00AA, 0x00AA }, { 0x00B5, 0x00B5 }, { 0x00BA, 0x00BA },
+	{ 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x02AF }, // Latin
+	{ 0x0370, 0x0373 }, { 0x0376, 0x0377 }, { 0x037B, 0x037D }, { 0x037F, 0x037F },
+	{ 0x0386, 0x0386 }, { 0x0388, 0x03FF }, // Greek
+	{ 0x0400, 0x0481 }, { 0x048A, 0x052F }, // Cyrillic
+	{ 0x0531, 0x0556 }, { 0x0560, 0x0588 }, // Armenian
+	{ 0x05D0, 0x05EA }, // Hebrew
+	{ 0x0620, 0x064A }, { 0x0671, 0x06D3 }, // Arabic
+	{ 0x1E00, 0x1FFF }, // Latin and Greek extended
+	{ 0x3041, 0x3096 }, { 0x30A1, 0x30FA }, // Kana
+	{ 0x4E00, 0x9FFF }, // CJK
+	{ 0xAC00, 0xD7A3 }, // Hangul
+};
+
+struct CaseRange {
+	char32_t first;
+	char32_t last;
+	int32_t delta;
+	uint8_t stride; // 2: only every other code point is uppercase
+};
+
+// Sorted
+constexpr CaseRange CaseRanges[] = {
+	{ 0x00C0, 0x00D6, 32, 1 }, { 0x00D8, 0x00DE, 32, 1 },
+	{ 0x0100, 0x012F, 1, 2 }, { 0x0132, 0x0137, 1, 2 }, { 0x0139, 0x0148, 1, 2 },
+	{ 0x014A, 0x0177, 1, 2 }, { 0x0178, 0x0178, -121, 1 }, { 0x0179, 0x017E, 1, 2 },
+	{ 0x0386, 0x0386, 38, 1 }, { 0x0388, 0x038A, 37, 1 }, { 0x038C, 0x038C, 64, 1 },
+	{ 0x038E, 0x038F, 63, 1 }, { 0x0391, 0x03A1, 32, 1 }, { 0x03A3, 0x03AB, 32, 1 },
+	{ 0x0400, 0x040F, 80, 1 }, { 0x0410, 0x042F, 32, 1 },
+	{ 0x0460, 0x0481, 1, 2 }, { 0x048A, 0x04BF, 1, 2 }, { 0x04D0, 0x052F, 1, 2 },
+	{ 0x0531, 0x0556, 48, 1 },
+	{ 0x1E00, 0x1E95, 1, 2 }, { 0x1EA0, 0x1EFF, 1, 2 },
+};
+
+}
+
+namespace utf8 {
+
+std::optional<char32_t> decode(std::string_view text, size_t i, size_t& length) {
+	const unsigned char lead = text[i];
+	char32_t cp;
+	char32_t min;
+	if (lead < 0x80) {
+		length = 1;
+		return lead;
+	} else if ((lead & 0xE0) == 0xC0) {
+		length = 2;
+		cp = lead & 0x1F;
+		min = 0x80;
+	} else if ((lead & 0xF0) == 0xE0) {
+		length = 3;
+		cp = lead & 0x0F;
+		min = 0x800;
+	} else if ((lead & 0xF8) == 0xF0) {
+		length = 4;
+		cp = lead & 0x07;
+		min = 0x10000;
+	} else {
+		length = 1;
+		return std::nullopt;
+	}
+
+	if (i + length > text.size()) {
+		length = 1;
+		return std::nullopt;
+	}
+
+	for (size_t k = 1; k < length; ++k) {
+		const unsigned char c = text[i + k];
+		if ((c & 0xC0) != 0x80) {
+			length = 1;
+			return std::nullopt;
+		}
+		cp = (cp << 6) | (c & 0x3F);
+	}
+
+	if ((cp < min) || (cp > 0x10FFFF) || ((cp >= 0xD800) && (cp <= 0xDFFF))) {
+		length = 1;
+		return std::nullopt;
+	}
+
+	return cp;
+}
+
+void append(std::string& out, char32_t cp) {
+	if (cp < 0x80) {
+		out += static_cast<char>(cp);
+	} else if (cp < 0x800) {
+		out += static_cast<char>(0xC0 | (cp >> 6));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	} else if (cp < 0x10000) {
+		out += static_cast<char>(0xE0 | (cp >> 12));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	} else {
+		out += static_cast<char>(0xF0 | (cp >> 18));
+		out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	}
+}
+
+bool is_letter(char32_t cp) {
+	if (cp < 0x80) {
+		return ((cp | 0x20) >= 'a') && ((cp | 0x20) <= 'z');
+	}
+
+	const auto it = std::upper_bound(std::begin(LetterRanges), std::end(LetterRanges), cp, [](char32_t v, const Range& r) {
+		return v < r.first;
+	});
+	return (it != std::begin(LetterRanges)) && (cp <= std::prev(it)->last);
+}
+
+char32_t to_lower(char32_t cp) {
+	if (cp < 0x80) {
+		return ((cp >= 'A') && (cp <= 'Z')) ? (cp | 0x20) : cp;
+	}
+
+	const auto it = std::upper_bound(std::begin(CaseRanges), std::end(CaseRanges), cp, [](char32_t v, const CaseRange& r) {
+		return v < r.first;
+	});
+	if (it == std::begin(CaseRanges)) {
+		return cp;
+	}
+
+	const CaseRange& range = *std::prev(it);
+	if ((cp > range.last) || ((cp - range.first) % range.stride != 0)) {
+		return cp;
+	}
+
+	return static_cast<char32_t>(static_cast<int32_t>(cp) + range.delta);
+}
+
+}
+
+Tokenizer::Tokenizer(std::string_view splitters) {
+	m_classes.fill(Class::Other);
+	for (unsigned char c = 'a'; c <= 'z'; ++c) {
+		m_classes[c] = Class::Lower;
+		m_classes[c & ~0x20] = Class::Upper;
+	}
+	for (unsigned char c : splitters) {
+		m_classes[c] = Class::Splitter;
+	}
+}
+
+bool Tokenizer::is_splitter(unsigned char c) const {
+	return m_classes[c] == Class::Splitter;
+}
+
+std::string Tokenizer::fold(std::string_view text) const {
+	std::string folded;
+	folded.reserve(text.size());
+	scan(text, [&folded](char c) {
+		folded += c;
+	}, [&folded](const std::string& token, bool) {
+		folded += token;
+	});
+
+	return folded;
+}
+
+const Tokenizer& default_tokenizer() {
+	static const Tokenizer tokenizer{};
+	return tokenizer;
+}
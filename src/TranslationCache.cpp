@@ -0,0 +1,245 @@
+#include "TranslationCache.hpp"
+
+#include "StringProcess.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint64_t FNVOffset = 0xcbf29ce484222325;
+constexpr uint64_t FNVPrime = 0x100000001b3;
+
+uint64_t fnv1a(std::string_view bytes, uint64_t h = FNVOffset) {
+	for (unsigned char c : bytes) {
+		h ^= c;
+		h *= FNVPrime;
+	}
+
+	return h;
+}
+
+// Unrelated to fnv1a, only compared when two contents share a key
+uint64_t content_check(std::string_view content) {
+	uint64_t h = 0x9e3779b97f4a7c15 ^ content.size();
+	for (unsigned char c : content) {
+		h = (h ^ c) * 0xff51afd7ed558ccd;
+		h ^= h >> 32;
+	}
+
+	return h;
+}
+
+uint64_t words_fingerprint(const std::vector<std::string>& words, const Dictionnary& dict, uint64_t seed) {
+	uint64_t h = seed;
+	for (const std::string& word : words) {
+		h = fnv1a(word, h);
+		// Separate known and unknown words, mapping may be empty
+		if (dict.contains(word)) {
+			h = fnv1a("\x01", h);
+			h = fnv1a(dict[word], h);
+		} else {
+			h = fnv1a("\x02", h);
+		}
+	}
+
+	return h;
+}
+
+// FNVOffset without phrases, order independent
+uint64_t phrases_fingerprint(const Dictionnary& dict) {
+	uint64_t phrases = 0;
+	dict.for_each([&phrases](std::string_view key, std::string_view value) {
+		if (std::any_of(key.begin(), key.end(), is_splitter)) {
+			phrases += fnv1a(value, fnv1a("\x01", fnv1a(key)));
+		}
+	});
+
+	return FNVOffset ^ phrases;
+}
+
+}
+
+bool CachedTranslation::complete() const {
+	return nb_translated_words == nb_words;
+}
+
+uint64_t content_hash(std::string_view content) {
+	return fnv1a(content);
+}
+
+TranslationCache::TranslationCache(size_t capacity)
+	: m_capacity{ std::max<size_t>(capacity, 1) } { }
+
+void TranslationCache::refresh(const Dictionnary& dict) {
+	if (m_translator.has_value() && (m_translator_generation == dict.generation())) {
+		return;
+	}
+
+	m_translator.emplace(dict);
+	m_translator_generation = dict.generation();
+	m_phrases_fingerprint = phrases_fingerprint(dict);
+}
+
+const CachedTranslation* TranslationCache::find(std::string_view content, const Dictionnary& dict) {
+	const auto it = m_entries.find(content_hash(content));
+	if (it == m_entries.end()) {
+		return nullptr;
+	}
+
+	// Another content with the same key, replaced by the next translate()
+	Entry& entry = it->second;
+	if ((entry.length != content.size()) || (entry.check != content_check(content))) {
+		return nullptr;
+	}
+
+	refresh(dict);
+	if (words_fingerprint(entry.words, dict, m_phrases_fingerprint) != entry.fingerprint) {
+		m_entries.erase(it);
+		return nullptr;
+	}
+
+	entry.last_used = ++m_clock;
+	return &entry.translation;
+}
+
+const CachedTranslation& TranslationCache::translate(std::string_view content, const Dictionnary& dict) {
+	const CachedTranslation* cached = find(content, dict);
+	if (cached != nullptr) {
+		return *cached;
+	}
+
+	std::vector<std::string> words = get_unique_words(content);
+	size_t nb_translated_words = 0;
+	for (const std::string& word : words) {
+		nb_translated_words += dict.contains(word);
+	}
+
+	refresh(dict);
+	Entry entry {
+		content.size(),
+		content_check(content),
+		++m_clock,
+		{},
+		words_fingerprint(words, dict, m_phrases_fingerprint),
+		CachedTranslation{ m_translator->translate(content), words.size(), nb_translated_words }
+	};
+	entry.words = std::move(words);
+
+	const uint64_t hash = content_hash(content);
+	if (!m_entries.contains(hash) && (m_entries.size() >= m_capacity)) {
+		evict();
+	}
+
+	Entry& stored = m_entries[hash] = std::move(entry);
+	return stored.translation;
+}
+
+size_t TranslationCache::size() const {
+	return m_entries.size();
+}
+
+void TranslationCache::retain(const std::vector<std::string_view>& contents) {
+	std::unordered_map<uint64_t, Entry> kept;
+	for (std::string_view content : contents) {
+		const auto it = m_entries.find(content_hash(content));
+		if ((it != m_entries.end()) && (it->second.length == content.size()) && (it->second.check == content_check(content))) {
+			kept.insert(m_entries.extract(it));
+		}
+	}
+
+	m_entries.swap(kept);
+}
+
+// Linear scan, only done when a full cache learns a new content
+void TranslationCache::evict() {
+	const auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const auto& a, const auto& b) {
+		return a.second.last_used < b.second.last_used;
+	});
+	if (oldest != m_entries.end()) {
+		m_entries.erase(oldest);
+	}
+}
+
+// Sequence of records, each one preceded by its little endian u32 size
+std::string TranslationCache::serialize() const {
+	std::string data;
+	for (const auto& [hash, entry] : m_entries) {
+		std::string words;
+		for (const std::string& word : entry.words) {
+			if (!words.empty()) {
+				words += ' ';
+			}
+			words += word;
+		}
+
+		const std::vector<uint8_t> record = RecordSchema::encode(
+			hash, entry.length, entry.check, entry.fingerprint, static_cast<uint32_t>(entry.translation.nb_translated_words),
+			words, entry.translation.content
+		);
+		const std::vector<uint8_t> size = schema::Schema<schema::LE<uint32_t>>::encode(static_cast<uint32_t>(record.size()));
+		data.append(size.begin(), size.end());
+		data.append(record.begin(), record.end());
+	}
+
+	return data;
+}
+
+void TranslationCache::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::binary };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save translation cache");
+	}
+
+	outfile << serialize();
+
+	outfile.close();
+}
+
+std::future<void> TranslationCache::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	return writer.write(std::move(filepath), serialize());
+}
+
+void TranslationCache::read_on_disk(std::string filepath) {
+	std::ifstream infile{ filepath, std::ios::binary };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read translation cache");
+	}
+
+	const std::vector<uint8_t> data{ std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>() };
+	infile.close();
+
+	// Stop at the first corrupted record, the cache is only an optimisation
+	const std::span<const uint8_t> bytes{ data };
+	size_t offset = 0;
+	while ((offset + 4 <= bytes.size()) && (m_entries.size() < m_capacity)) {
+		const auto size = schema::Schema<schema::LE<uint32_t>>::decode(bytes.subspan(offset, 4));
+		offset += 4;
+		const size_t record_size = std::get<0>(*size);
+		if (record_size > bytes.size() - offset) {
+			break;
+		}
+
+		auto record = RecordSchema::decode(bytes.subspan(offset, record_size));
+		offset += record_size;
+		if (!record.has_value()) {
+			break;
+		}
+
+		auto& [hash, length, check, fingerprint, nb_translated_words, words, content] = *record;
+		Entry entry{ length, check, ++m_clock, {}, fingerprint, CachedTranslation{ std::move(content), 0, nb_translated_words } };
+		std::istringstream iss(words);
+		std::string word;
+		while (iss >> word) {
+			entry.words.push_back(word);
+		}
+		entry.translation.nb_words = entry.words.size();
+
+		m_entries[hash] = std::move(entry);
+	}
+}
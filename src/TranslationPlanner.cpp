@@ -0,0 +1,127 @@
+#include "TranslationPlanner.hpp"
+
+#include "StringProcess.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+std::string rejected_words_text(const RejectedWords& rejected) {
+	// Sorted, the file does not change with the hash order
+	std::vector<std::string_view> words{ rejected.words.begin(), rejected.words.end() };
+	std::sort(words.begin(), words.end());
+
+	std::ostringstream oss;
+	for (std::string_view word : words) {
+		oss << word << "\n";
+	}
+
+	return oss.str();
+}
+
+}
+
+bool RejectedWords::contains(const std::string& word) const {
+	return words.contains(word);
+}
+
+void RejectedWords::save_on_disk(std::string filepath) const {
+	std::ofstream outfile{ filepath, std::ios::out };
+	if (!outfile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to save rejected words");
+	}
+
+	outfile << rejected_words_text(*this);
+
+	outfile.close();
+}
+
+std::future<void> RejectedWords::save_on_disk(DiskWriter& writer, std::string filepath) const {
+	return writer.write(std::move(filepath), rejected_words_text(*this));
+}
+
+void RejectedWords::read_on_disk(std::string filepath) {
+	std::ifstream infile{ filepath, std::ios::in };
+	if (!infile.is_open()) {
+		throw std::runtime_error("Error: Could not open " + filepath + " to read rejected words");
+	}
+
+	std::string word;
+	while (std::getline(infile, word)) {
+		if (!word.empty()) {
+			words.insert(word);
+		}
+	}
+
+	infile.close();
+}
+
+TranslationPlanner::TranslationPlanner(const std::vector<Mail>& mails, const Dictionnary& dict, const RejectedWords& rejected)
+	: m_next{ 0 }
+	, m_total_occurrences{ 0 }
+	, m_known_occurrences{ 0 }
+{
+	std::unordered_map<std::string, size_t> word_index;
+	for (size_t i = 0; i < mails.size(); ++i) {
+		for (const auto& [word, count] : count_words(mails[i].text())) {
+			if (rejected.contains(word)) {
+				continue;
+			}
+
+			m_total_occurrences += count;
+			if (dict.contains(word)) {
+				m_known_occurrences += count;
+				continue;
+			}
+
+			const auto [it, inserted] = word_index.try_emplace(word, m_plan.size());
+			if (inserted) {
+				m_plan.push_back(PlannedWord{ word, 0, {} });
+			}
+			m_plan[it->second].occurrences += count;
+			m_plan[it->second].mails.push_back(i);
+		}
+	}
+
+	// Gains are independent from each other, a static order is optimal
+	std::sort(m_plan.begin(), m_plan.end(), [](const PlannedWord& a, const PlannedWord& b) {
+		if (a.occurrences != b.occurrences) {
+			return a.occurrences > b.occurrences;
+		}
+		return a.word < b.word;
+	});
+}
+
+bool TranslationPlanner::done() const {
+	return m_next >= m_plan.size();
+}
+
+size_t TranslationPlanner::remaining() const {
+	return m_plan.size() - m_next;
+}
+
+const PlannedWord& TranslationPlanner::next() const {
+	assert(!done());
+	return m_plan[m_next];
+}
+
+void TranslationPlanner::pop(bool translated) {
+	assert(!done());
+	if (translated) {
+		m_known_occurrences += m_plan[m_next].occurrences;
+	}
+	++m_next;
+}
+
+double TranslationPlanner::coverage() const {
+	if (m_total_occurrences == 0) {
+		return 1.0;
+	}
+
+	return static_cast<double>(m_known_occurrences) / static_cast<double>(m_total_occurrences);
+}
@@ -0,0 +1,138 @@
+#include "AllocationTracker.hpp"
+#include "DiskWriter.hpp"
+#include "MappedFile.hpp"
+#include "Packet.hpp"
+#include "Protocol.hpp"
+#include "StringProcess.hpp"
+#include "TCPConnect.hpp"
+#include <gtest/gtest.h>
+
+#include "Loopback.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TEST(AllocationTests, tracker) {
+	AllocationScope scope;
+	EXPECT_EQ(scope.stats().allocations, 0);
+
+	// Called directly: new expressions may be elided by an optimising build
+	void* volatile first = ::operator new(16);
+	void* volatile second = ::operator new(100);
+	::operator delete(second);
+	::operator delete(first);
+
+	const AllocationStats stats = scope.stats();
+	EXPECT_EQ(stats.allocations, 2);
+	EXPECT_EQ(stats.deallocations, 2);
+	EXPECT_EQ(stats.bytes, 16 + 100);
+}
+
+TEST(AllocationTests, send_and_recv_packet) {
+	Listener listener;
+	TCPConnect connection{ "127.0.0.1", std::to_string(listener.port) };
+	const int peer = accept(listener.fd, nullptr, nullptr);
+	ASSERT_GE(peer, 0);
+
+	const Packet mail{ PacketType::Mail, MailSchema::encode(1, 1234, "alice", std::string(1000, 'x')) };
+	{
+		// The wire buffer only
+		AllocationScope scope;
+		send_packet(connection, mail);
+		EXPECT_EQ(scope.stats().allocations, 1);
+	}
+
+	std::vector<char> data;
+	serialize_packet(data, mail);
+	std::vector<char> received(data.size());
+	ASSERT_EQ(::recv(peer, received.data(), received.size(), MSG_WAITALL), static_cast<ssize_t>(data.size()));
+	::send(peer, received.data(), received.size(), 0);
+	while (connection.bytes().size() < data.size()) {
+		connection.recv();
+	}
+
+	{
+		// The payload only, bytes are already pending
+		AllocationScope scope;
+		const Packet p = recv_packet(connection);
+		EXPECT_EQ(scope.stats().allocations, 1);
+		EXPECT_EQ(scope.stats().bytes, mail.payload.size());
+	}
+
+	close(peer);
+}
+
+TEST(AllocationTests, handlers) {
+	const Packet result{ PacketType::Result, ResultSchema::encode(0x00) };
+	const Packet status{ PacketType::Status, StatusSchema::encode(3, 10, 0) };
+	const Packet mail{ PacketType::Mail, MailSchema::encode(1, 1234, "alice", std::string(1000, 'x')) };
+
+	AllocationScope scope;
+	handle_result_packet(result);
+	handle_status_packet(status);
+	EXPECT_EQ(scope.stats().allocations, 0);
+
+	// Content only, the short username fits in place
+	handle_mail_packet(mail);
+	EXPECT_EQ(scope.stats().allocations, 1);
+}
+
+TEST(AllocationTests, spilled_mail) {
+	const std::string content(1 << 20, 'x');
+	const std::vector<uint8_t> payload = MailSchema::encode(7, 1234, "alice", content);
+	auto file = std::make_shared<MappedFile>("", payload.size());
+	std::copy(payload.begin(), payload.end(), file->bytes().begin());
+	const Packet packet{ PacketType::Mail, std::nullopt, file };
+
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_spilled_mail.txt").string();
+	DiskWriter writer{ false };
+	{
+		// Decoded and saved from the mapping, the content is never copied
+		AllocationScope scope;
+		const Mail mail = handle_mail_packet(packet);
+		mail.save_on_disk(writer, filepath);
+		writer.flush();
+		EXPECT_LT(scope.stats().bytes, content.size() / 16);
+	}
+
+	std::ifstream infile{ filepath, std::ios::binary };
+	const std::string saved{ std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>() };
+	EXPECT_EQ(saved.size(), std::string("Mail n°7\nSent by alice at 1234\nContent:\n").size() + content.size());
+	EXPECT_TRUE(saved.ends_with(content));
+
+	std::filesystem::remove(filepath);
+}
+
+TEST(AllocationTests, translate) {
+	const std::unordered_map<std::string, std::string> mapping {
+		{ "foo", "doo" },
+		{ "bar", "dar" },
+	};
+	std::string text;
+	for (size_t i = 0; i < 100; ++i) {
+		text += "Foo, bar baz. ";
+	}
+
+	// Output only, words are short enough not to allocate
+	AllocationScope scope;
+	const std::string translated = translate(text, mapping);
+	EXPECT_EQ(scope.stats().allocations, 1);
+}
+
+TEST(AllocationTests, get_unique_words) {
+	std::string text;
+	for (size_t i = 0; i < 100; ++i) {
+		text += "Foo, bar baz. ";
+	}
+
+	// Per unique word: a map node. Then buckets, rehashes and the result vector
+	AllocationScope scope;
+	const std::vector<std::string> words = get_unique_words(text);
+	EXPECT_EQ(words.size(), 3);
+	EXPECT_LE(scope.stats().allocations, 3 + 4);
+}
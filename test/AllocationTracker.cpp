@@ -0,0 +1,98 @@
+#include "AllocationTracker.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Constant initialised, reading it never allocates
+thread_local AllocationStats thread_stats{ 0, 0, 0 };
+
+void* allocate(size_t size) {
+	++thread_stats.allocations;
+	thread_stats.bytes += size;
+
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocate_aligned(size_t size, std::align_val_t alignment) {
+	++thread_stats.allocations;
+	thread_stats.bytes += size;
+
+	const size_t align = static_cast<size_t>(alignment);
+	// aligned_alloc wants a multiple of the alignment
+	return std::aligned_alloc(align, ((size + align - 1) / align) * align);
+}
+
+void deallocate(void* ptr) {
+	if (ptr != nullptr) {
+		++thread_stats.deallocations;
+		std::free(ptr);
+	}
+}
+
+}
+
+AllocationScope::AllocationScope()
+	: m_start{ thread_stats } { }
+
+AllocationStats AllocationScope::stats() const {
+	return AllocationStats {
+		thread_stats.allocations - m_start.allocations,
+		thread_stats.deallocations - m_start.deallocations,
+		thread_stats.bytes - m_start.bytes
+	};
+}
+
+void* operator new(size_t size) {
+	void* ptr = allocate(size);
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	void* ptr = allocate_aligned(size, alignment);
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocate_aligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocate_aligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(ptr); }
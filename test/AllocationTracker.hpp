@@ -0,0 +1,24 @@
+#ifndef ALLOCATIONTRACKER_HPP
+#define ALLOCATIONTRACKER_HPP
+
+#include <cstddef>
+
+struct AllocationStats {
+	size_t allocations;
+	size_t deallocations;
+	size_t bytes; // Requested by the allocations
+};
+
+// Global operator new/delete calls made by the current thread while the scope
+// is alive, other threads (disk writer, pipeline stages) are not counted
+class AllocationScope {
+public:
+	AllocationScope();
+
+	AllocationStats stats() const;
+
+private:
+	AllocationStats m_start;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "ByteReader.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(ByteReaderTests, checked_reads) {
+	const std::vector<uint8_t> bytes{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+	ByteReader reader{ bytes };
+
+	uint16_t u16;
+	ASSERT_TRUE(reader.read_le(u16));
+	EXPECT_EQ(u16, 0x0201);
+
+	uint32_t u32;
+	ASSERT_TRUE(reader.read_le(u32));
+	EXPECT_EQ(u32, 0x06050403);
+	EXPECT_EQ(reader.offset(), 6);
+
+	// Failed reads leave the cursor where it was
+	EXPECT_FALSE(reader.read_le(u16));
+	std::span<const uint8_t> span;
+	EXPECT_FALSE(reader.read_span(2, span));
+	EXPECT_EQ(reader.remaining(), 1);
+
+	ASSERT_TRUE(reader.read_span(1, span));
+	EXPECT_EQ(span[0], 0x07);
+	EXPECT_TRUE(reader.empty());
+}
+
+TEST(ByteReaderTests, partial_width_and_expect) {
+	const std::vector<uint8_t> bytes{ 'X', 'R', 0x34, 0x12 };
+	ByteReader reader{ bytes };
+
+	const uint8_t wrong[] = { 'X', 'X' };
+	const uint8_t magic[] = { 'X', 'R' };
+	EXPECT_FALSE(reader.expect(wrong));
+	ASSERT_TRUE(reader.expect(magic));
+
+	uint32_t length;
+	EXPECT_FALSE(reader.read_le(length, 3));
+	ASSERT_TRUE(reader.read_le(length, 2));
+	EXPECT_EQ(length, 0x1234);
+
+	uint8_t u8;
+	EXPECT_FALSE(reader.read_le(u8, 2));
+}
@@ -0,0 +1,99 @@
+#include "Dictionnary.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+TEST(DictionnaryTests, insert_and_lookup) {
+	Dictionnary dict;
+	EXPECT_FALSE(dict.contains("foo"));
+	EXPECT_THROW(std::as_const(dict)["foo"], std::out_of_range);
+
+	dict["foo"] = "doo";
+	EXPECT_TRUE(dict.contains("foo"));
+	EXPECT_EQ(std::as_const(dict)["foo"], "doo");
+	EXPECT_EQ(dict.size(), 1);
+
+	// Unknown word inserted with an empty translation
+	EXPECT_EQ(std::string_view{ dict["bar"] }, "");
+	EXPECT_TRUE(dict.contains("bar"));
+	EXPECT_EQ(dict.size(), 2);
+
+	// Growth keeps every entry, replaced values are compacted away
+	for (size_t i = 0; i < 1000; ++i) {
+		dict["word" + std::to_string(i)] = "value" + std::to_string(i);
+	}
+	for (size_t i = 0; i < 100; ++i) {
+		dict["foo"] = "doo" + std::to_string(i);
+	}
+	EXPECT_EQ(dict.size(), 1002);
+	for (size_t i = 0; i < 1000; ++i) {
+		ASSERT_EQ(std::as_const(dict)["word" + std::to_string(i)], "value" + std::to_string(i));
+	}
+	EXPECT_EQ(std::as_const(dict)["foo"], "doo99");
+}
+
+TEST(DictionnaryTests, generation) {
+	Dictionnary dict;
+	const uint64_t initial = dict.generation();
+
+	dict["foo"] = "doo";
+	const uint64_t learnt = dict.generation();
+	EXPECT_GT(learnt, initial);
+
+	// Lookups and identical assignments change nothing
+	EXPECT_TRUE(dict.contains("foo"));
+	dict["foo"] = "doo";
+	EXPECT_EQ(dict.generation(), learnt);
+
+	// Unique across dictionnaries
+	Dictionnary other;
+	EXPECT_NE(other.generation(), initial);
+	other["foo"] = "doo";
+	EXPECT_NE(other.generation(), learnt);
+}
+
+TEST(DictionnaryTests, save_and_read) {
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_dictionnary.txt").string();
+
+	Dictionnary saved;
+	saved["foo"] = "doo";
+	saved["bar"] = "dar";
+	saved.save_on_disk(filepath);
+
+	Dictionnary dict;
+	dict.read_on_disk(filepath);
+	EXPECT_EQ(dict.size(), 2);
+	EXPECT_EQ(std::as_const(dict)["foo"], "doo");
+	EXPECT_EQ(std::as_const(dict)["bar"], "dar");
+
+	std::filesystem::remove(filepath);
+}
+
+TEST(DictionnaryTests, save_and_read_phrases) {
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_dictionnary_phrases.txt").string();
+
+	Dictionnary saved;
+	saved["foo bar"] = "doo dar";
+	saved["baz"] = "a longer translation";
+	saved.save_on_disk(filepath);
+
+	Dictionnary dict;
+	dict.read_on_disk(filepath);
+	EXPECT_EQ(dict.size(), 2);
+	EXPECT_EQ(std::as_const(dict)["foo bar"], "doo dar");
+	EXPECT_EQ(std::as_const(dict)["baz"], "a longer translation");
+
+	// Previous format, a word and its translation separated by a space
+	{
+		std::ofstream outfile{ filepath };
+		outfile << "qux dux\n";
+	}
+	Dictionnary old;
+	old.read_on_disk(filepath);
+	EXPECT_EQ(std::as_const(old)["qux"], "dux");
+
+	std::filesystem::remove(filepath);
+}
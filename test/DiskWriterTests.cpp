@@ -0,0 +1,96 @@
+#include "DiskWriter.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+static std::string read_file(const std::filesystem::path& filepath) {
+	std::ifstream infile{ filepath, std::ios::binary };
+	return std::string{ std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>() };
+}
+
+TEST(DiskWriterTests, write_and_coalesce) {
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "xr2000_disk_writer";
+	std::filesystem::create_directories(dir);
+	const std::string filepath = (dir / "file.txt").string();
+
+	DiskWriter writer;
+	std::future<void> first = writer.write(filepath, "first");
+	std::future<void> second = writer.write(filepath, "second");
+	std::future<void> other = writer.write((dir / "other.txt").string(), std::string(1 << 20, 'x'));
+	writer.flush();
+
+	EXPECT_NO_THROW(first.get());
+	EXPECT_NO_THROW(second.get());
+	EXPECT_NO_THROW(other.get());
+	EXPECT_EQ(read_file(filepath), "second");
+	EXPECT_EQ(read_file(dir / "other.txt").size(), 1 << 20);
+
+	std::filesystem::remove_all(dir);
+}
+
+TEST(DiskWriterTests, write_tail_in_place) {
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "xr2000_disk_writer_tail";
+	std::filesystem::create_directories(dir);
+	const std::string filepath = (dir / "file.bin").string();
+
+	DiskWriter writer;
+	{
+		// Released by the caller before the write ran, kept alive by the writer
+		auto tail = std::make_shared<const std::vector<uint8_t>>(1 << 20, 'y');
+		writer.write(filepath, "head", *tail, tail);
+	}
+	writer.flush();
+
+	EXPECT_EQ(read_file(filepath), "head" + std::string(1 << 20, 'y'));
+
+	std::filesystem::remove_all(dir);
+}
+
+TEST(DiskWriterTests, report_errors) {
+	DiskWriter writer{ false };
+	std::future<void> failed = writer.write("/nonexistent_xr2000_dir/file.txt", "content");
+
+	EXPECT_THROW(failed.get(), std::runtime_error);
+	EXPECT_THROW(writer.flush(), std::runtime_error);
+	// Error is reported once
+	EXPECT_NO_THROW(writer.flush());
+}
+
+#ifdef XR2000_HAS_IO_URING
+TEST(DiskWriterTests, io_uring_batches) {
+	DiskWriter writer;
+	if (!writer.uses_io_uring()) {
+		GTEST_SKIP() << "io_uring unavailable on this kernel";
+	}
+
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "xr2000_disk_writer_uring";
+	std::filesystem::create_directories(dir);
+
+	// More files than a single submission holds, half of them with a tail
+	auto tail = std::make_shared<const std::vector<uint8_t>>(4096, 't');
+	std::vector<std::future<void>> done;
+	for (size_t i = 0; i < 100; ++i) {
+		const std::string filepath = (dir / ("file" + std::to_string(i))).string();
+		if (i % 2) {
+			done.push_back(writer.write(filepath, std::to_string(i), *tail, tail));
+		} else {
+			done.push_back(writer.write(filepath, std::to_string(i)));
+		}
+	}
+	writer.flush();
+
+	for (size_t i = 0; i < done.size(); ++i) {
+		EXPECT_NO_THROW(done[i].get());
+		const std::string expected = std::to_string(i) + ((i % 2) ? std::string(4096, 't') : "");
+		EXPECT_EQ(read_file(dir / ("file" + std::to_string(i))), expected);
+	}
+	EXPECT_TRUE(writer.uses_io_uring());
+
+	std::filesystem::remove_all(dir);
+}
+#endif
@@ -0,0 +1,74 @@
+#include "Dispatcher.hpp"
+#include "Protocol.hpp"
+#include "TCPConnect.hpp"
+#include <gtest/gtest.h>
+
+#include "Loopback.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+static_assert(Dispatcher::index(PacketType::Result) == 0x1f);
+static_assert(Dispatcher::mask({ PacketType::Help, PacketType::Result }) == 0x80000001);
+
+TEST(DispatcherTests, expected_packet_returned) {
+	Dispatcher dispatcher;
+	const uint32_t expected = Dispatcher::mask({ PacketType::Translation, PacketType::Result });
+
+	const std::optional<Packet> p = dispatcher.route(Packet{ PacketType::Result, std::vector<uint8_t>{ 0x12 } }, expected);
+	ASSERT_TRUE(p.has_value());
+	EXPECT_EQ(p->type, PacketType::Result);
+	EXPECT_EQ(p->payload, std::vector<uint8_t>{ 0x12 });
+}
+
+TEST(DispatcherTests, unsolicited_packet_handled) {
+	Dispatcher dispatcher;
+	size_t nb_status = 0;
+	dispatcher.on(PacketType::Status, [&nb_status](const Packet& p) {
+		EXPECT_EQ(p.type, PacketType::Status);
+		++nb_status;
+	});
+
+	const uint32_t expected = Dispatcher::mask({ PacketType::Mail });
+	EXPECT_FALSE(dispatcher.route(Packet{ PacketType::Status }, expected).has_value());
+	EXPECT_EQ(nb_status, 1);
+
+	// Expected packets win over handlers
+	EXPECT_TRUE(dispatcher.route(Packet{ PacketType::Status }, Dispatcher::mask({ PacketType::Status })).has_value());
+	EXPECT_EQ(nb_status, 1);
+}
+
+TEST(DispatcherTests, unexpected_packet_throw) {
+	Dispatcher dispatcher;
+	EXPECT_THROW(dispatcher.route(Packet{ PacketType::Mail }, Dispatcher::mask({ PacketType::Hello })), std::runtime_error);
+}
+
+TEST(DispatcherTests, pushed_mail_during_getmail) {
+	Listener listener;
+	TCPConnect connection{ "127.0.0.1", std::to_string(listener.port) };
+	const int peer = accept(listener.fd, nullptr, nullptr);
+	ASSERT_GE(peer, 0);
+
+	Dispatcher dispatcher;
+	std::vector<uint32_t> pushed;
+	dispatcher.on(PacketType::Mail, [&pushed](const Packet& p) {
+		pushed.push_back(handle_mail_packet(p).id);
+	});
+
+	// A notification arrives between GetMail 1 and its response, then GetMail 2 is answered
+	std::vector<char> data;
+	serialize_packet(data, Packet{ PacketType::Mail, MailSchema::encode(9, 0, "server", "new mail") });
+	serialize_packet(data, Packet{ PacketType::Mail, MailSchema::encode(1, 0, "alice", "first") });
+	serialize_packet(data, Packet{ PacketType::Mail, MailSchema::encode(2, 0, "bob", "second") });
+	::send(peer, data.data(), data.size(), 0);
+
+	for (uint32_t i = 1; i <= 2; ++i) {
+		const Packet p = dispatcher.wait_for(connection, Dispatcher::mask({ PacketType::Mail }), [i](const Packet& candidate) {
+			return decode_mail_id(candidate) == i;
+		});
+		EXPECT_EQ(handle_mail_packet(p).id, i);
+	}
+	EXPECT_EQ(pushed, std::vector<uint32_t>{ 9 });
+
+	close(peer);
+}
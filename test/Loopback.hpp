@@ -0,0 +1,35 @@
+#ifndef LOOPBACK_HPP
+#define LOOPBACK_HPP
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+// IPv4 only loopback listener on an ephemeral port
+struct Listener {
+	int fd;
+	uint16_t port;
+
+	Listener() {
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+		listen(fd, 4);
+
+		socklen_t length = sizeof(addr);
+		getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length);
+		port = ntohs(addr.sin_port);
+	}
+
+	~Listener() {
+		close(fd);
+	}
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "MailOutbox.hpp"
+#include "TCPConnect.hpp"
+#include <gtest/gtest.h>
+
+#include "Loopback.hpp"
+
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+// Server side framing, header then payload
+Packet read_packet(int fd) {
+	uint8_t header[5];
+	::recv(fd, header, sizeof(header), MSG_WAITALL);
+	const bool request_id_present = header[0] & 0b00100000;
+	const uint8_t LF = LFL_to_LF(header[0] >> 6);
+
+	std::optional<uint8_t> request_id;
+	if (request_id_present) {
+		uint8_t id;
+		::recv(fd, &id, 1, MSG_WAITALL);
+		request_id = id;
+	}
+
+	uint8_t length_bytes[4] = { 0, 0, 0, 0 };
+	::recv(fd, length_bytes, LF, MSG_WAITALL);
+	const uint32_t length = length_bytes[0] | (length_bytes[1] << 8) | (length_bytes[2] << 16) | (length_bytes[3] << 24);
+
+	std::vector<uint8_t> payload(length);
+	::recv(fd, payload.data(), length, MSG_WAITALL);
+
+	return Packet{ static_cast<PacketType>(header[0] & 0b00011111), request_id, std::move(payload) };
+}
+
+}
+
+TEST(MailOutboxTests, pipelined_send_and_retry) {
+	Listener listener;
+	TCPConnect connection{ "127.0.0.1", std::to_string(listener.port) };
+	const int peer = accept(listener.fd, nullptr, nullptr);
+	ASSERT_GE(peer, 0);
+
+	// Answer pairs of requests in reverse order, bob is refused once
+	std::thread server{ [peer] {
+		std::vector<Packet> batch;
+		bool bob_refused = false;
+		for (size_t received = 1; received <= 6; ++received) {
+			batch.push_back(read_packet(peer));
+			if ((batch.size() < 2) && (received != 5) && (received != 6)) {
+				continue;
+			}
+
+			std::vector<char> data;
+			for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+				const auto fields = SendMailSchema::decode(it->payload);
+				uint8_t code = 0x00;
+				if (std::get<0>(*fields) == "bob" && !bob_refused) {
+					code = 0x04;
+					bob_refused = true;
+				}
+				serialize_packet(data, Packet{ PacketType::Result, it->request_id, ResultSchema::encode(code) });
+			}
+			::send(peer, data.data(), data.size(), 0);
+			batch.clear();
+		}
+	} };
+
+	MailOutbox outbox;
+	for (const char* recipient : { "alice", "bob", "carol", "dave", "eve" }) {
+		outbox.push(OutgoingMail{ recipient, std::string("hello ") + recipient });
+	}
+
+	Dispatcher dispatcher;
+	const SendReport first = outbox.send(connection, dispatcher, 2);
+	EXPECT_EQ(first.sent, 4);
+	EXPECT_EQ(first.failed, 1);
+	ASSERT_EQ(outbox.size(), 1);
+	EXPECT_EQ(outbox.pending()[0].mail.recipient, "bob");
+	EXPECT_EQ(outbox.pending()[0].last_result->code, 0x04);
+
+	const SendReport retry = outbox.send(connection, dispatcher, 2);
+	EXPECT_EQ(retry.sent, 1);
+	EXPECT_EQ(retry.failed, 0);
+	EXPECT_EQ(outbox.size(), 0);
+
+	server.join();
+	close(peer);
+}
+
+TEST(MailOutboxTests, save_and_read) {
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_outbox.dat").string();
+
+	MailOutbox saved;
+	saved.push(OutgoingMail{ "alice", "foo" });
+	saved.push(OutgoingMail{ "bob", std::string(300, 'x') });
+	saved.save_on_disk(filepath);
+
+	MailOutbox outbox;
+	outbox.read_on_disk(filepath);
+	ASSERT_EQ(outbox.size(), 2);
+	EXPECT_EQ(outbox.pending()[0].mail, saved.pending()[0].mail);
+	EXPECT_EQ(outbox.pending()[1].mail, saved.pending()[1].mail);
+
+	std::filesystem::remove(filepath);
+}
@@ -0,0 +1,53 @@
+#include "MailPipeline.hpp"
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+TEST(MailPipelineTests, stages_in_order) {
+	std::vector<std::string> persisted;
+	MailPipeline pipeline{
+		[](const Mail& mail) -> std::optional<std::string> {
+			if (mail.id % 2 == 0) {
+				return std::nullopt;
+			}
+			return "translated " + mail.content;
+		},
+		[&persisted](const Mail& mail, const std::optional<std::string>& translation) {
+			persisted.push_back(translation.value_or(mail.content));
+		},
+		2
+	};
+
+	for (uint32_t i = 1; i <= 5; ++i) {
+		pipeline.push(Mail{ i, 0, "sender", std::to_string(i) });
+	}
+	const std::vector<Mail> mails = pipeline.finish();
+
+	ASSERT_EQ(mails.size(), 5);
+	for (uint32_t i = 0; i < 5; ++i) {
+		EXPECT_EQ(mails[i].id, i + 1);
+		EXPECT_EQ(mails[i].content, std::to_string(i + 1));
+	}
+	const std::vector<std::string> expected = {
+		"translated 1", "2", "translated 3", "4", "translated 5"
+	};
+	EXPECT_EQ(persisted, expected);
+
+	EXPECT_EQ(pipeline.translate_metrics().processed, 5);
+	EXPECT_EQ(pipeline.persist_metrics().processed, 5);
+	EXPECT_LE(pipeline.persist_metrics().queue.max_occupancy, 2);
+}
+
+TEST(MailPipelineTests, stage_error_rethrown) {
+	MailPipeline pipeline{
+		[](const Mail&) -> std::optional<std::string> {
+			throw std::runtime_error("Error: translation failed");
+		},
+		[](const Mail&, const std::optional<std::string>&) { }
+	};
+
+	for (uint32_t i = 1; i <= 100; ++i) {
+		pipeline.push(Mail{ i, 0, "sender", "content" });
+	}
+	EXPECT_THROW(pipeline.finish(), std::runtime_error);
+}
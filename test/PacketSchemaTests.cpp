@@ -0,0 +1,69 @@
+#include "PacketSchema.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace schema;
+
+using FixedSchema = Schema<LE<uint32_t>, LE<uint16_t>, LE<uint8_t>>;
+using MixedSchema = Schema<LE<uint8_t>, U8String, U32Blob, LE<uint16_t>>;
+using TailSchema = Schema<LE<uint8_t>, Rest<std::string>>;
+
+static_assert(FixedSchema::min_size == 7);
+static_assert(FixedSchema::is_fixed);
+static_assert(MixedSchema::min_size == 1 + 1 + 4 + 2);
+static_assert(!MixedSchema::is_fixed);
+static_assert(TailSchema::min_size == 1);
+
+TEST(PacketSchemaTests, encode_little_endian) {
+	const std::vector<uint8_t> expected = { 0x04, 0x03, 0x02, 0x01, 0x06, 0x05, 0x07 };
+	EXPECT_EQ(FixedSchema::encode(0x01020304, 0x0506, 0x07), expected);
+
+	const std::vector<uint8_t> expected_mixed = {
+		0x01,
+		0x03, 'f', 'o', 'o',
+		0x02, 0x00, 0x00, 0x00, 0xaa, 0xbb,
+		0x34, 0x12
+	};
+	EXPECT_EQ(MixedSchema::encode(0x01, "foo", { 0xaa, 0xbb }, 0x1234), expected_mixed);
+}
+
+TEST(PacketSchemaTests, round_trip) {
+	const std::vector<uint8_t> payload = MixedSchema::encode(0x42, "hostname", { 0x00, 0x01, 0x02 }, 0xbeef);
+	const auto values = MixedSchema::decode(payload);
+	ASSERT_TRUE(values.has_value());
+	EXPECT_EQ(std::get<0>(*values), 0x42);
+	EXPECT_EQ(std::get<1>(*values), "hostname");
+	EXPECT_EQ(std::get<2>(*values), (std::vector<uint8_t>{ 0x00, 0x01, 0x02 }));
+	EXPECT_EQ(std::get<3>(*values), 0xbeef);
+
+	const auto tail = TailSchema::decode(TailSchema::encode(0x01, "foo bar"));
+	ASSERT_TRUE(tail.has_value());
+	EXPECT_EQ(std::get<1>(*tail), "foo bar");
+}
+
+TEST(PacketSchemaTests, reject_malformed) {
+	// Truncated fixed payload
+	EXPECT_FALSE(FixedSchema::decode(std::vector<uint8_t>{ 0x01, 0x02, 0x03 }).has_value());
+	// Trailing bytes
+	EXPECT_FALSE(FixedSchema::decode(std::vector<uint8_t>(8, 0x00)).has_value());
+
+	std::vector<uint8_t> payload = MixedSchema::encode(0x01, "foo", { 0xaa }, 0x0001);
+	// String length overflowing the payload
+	std::vector<uint8_t> overflow = payload;
+	overflow[1] = 0xff;
+	EXPECT_FALSE(MixedSchema::decode(overflow).has_value());
+	// Blob length eating the bytes of the last fixed field
+	std::vector<uint8_t> greedy = payload;
+	greedy[5] = 0x03;
+	EXPECT_FALSE(MixedSchema::decode(greedy).has_value());
+	// Missing last field
+	payload.pop_back();
+	EXPECT_FALSE(MixedSchema::decode(payload).has_value());
+}
+
+TEST(PacketSchemaTests, encode_too_long) {
+	const std::string too_long(256, 'a');
+	EXPECT_THROW(MixedSchema::encode(0x01, too_long, {}, 0x0000), std::runtime_error);
+}
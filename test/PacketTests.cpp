@@ -0,0 +1,28 @@
+#include "Packet.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(PacketTests, parse_header) {
+	const Packet p{ PacketType::Mail, 0x2a, std::vector<uint8_t>(300, 0x00) };
+	std::vector<char> data;
+	serialize_packet(data, p);
+
+	const std::vector<uint8_t> bytes(data.begin(), data.end());
+	const size_t size = header_size(bytes[0]);
+	EXPECT_EQ(size, 1 + 4 + 1 + 2);
+
+	const std::optional<PacketHeader> header = parse_header({ bytes.data(), size });
+	ASSERT_TRUE(header.has_value());
+	EXPECT_EQ(header->type, PacketType::Mail);
+	EXPECT_EQ(header->request_id, 0x2a);
+	EXPECT_EQ(header->payload_length, 300);
+
+	// Truncated, too long or without the magic
+	EXPECT_FALSE(parse_header({ bytes.data(), size - 1 }).has_value());
+	EXPECT_FALSE(parse_header({ bytes.data(), size + 1 }).has_value());
+	std::vector<uint8_t> corrupted(bytes.begin(), bytes.begin() + size);
+	corrupted[2] = 'Z';
+	EXPECT_FALSE(parse_header(corrupted).has_value());
+	EXPECT_FALSE(parse_header({}).has_value());
+}
@@ -0,0 +1,33 @@
+#include "PhraseTranslator.hpp"
+#include "StringProcess.hpp"
+#include <gtest/gtest.h>
+
+TEST(PhraseTranslatorTests, same_as_word_translation) {
+	const std::unordered_map<std::string, std::string> mapping{
+		{ "foo", "doo" }, { "fo", "x" }, { "foobar", "y" }, { "bar", "dar" }
+	};
+	const PhraseTranslator translator{ mapping };
+	EXPECT_EQ(translator.size(), 4);
+	EXPECT_EQ(translator.nb_phrases(), 0);
+
+	const std::vector<std::string> texts{
+		"", "foo", "Foo bar.", "fo, foob (foobar) FOOBARS-bar\nbaz:", "  foo  ", "-"
+	};
+	for (const std::string& text : texts) {
+		EXPECT_EQ(translator.translate(text), translate(text, mapping)) << text;
+	}
+}
+
+TEST(PhraseTranslatorTests, longest_phrase) {
+	const std::unordered_map<std::string, std::string> mapping{
+		{ "good", "bon" }, { "good morning", "bonjour" }, { "good morning sir", "bonjour monsieur" }, { "sir", "m" }
+	};
+	const PhraseTranslator translator{ mapping };
+	EXPECT_EQ(translator.nb_phrases(), 2);
+
+	EXPECT_EQ(translator.translate("Good morning sir."), "bonjour monsieur.");
+	EXPECT_EQ(translator.translate("Good morning, sir"), "bonjour, m");
+	EXPECT_EQ(translator.translate("good mornings sir"), "bon mornings m");
+	EXPECT_EQ(translator.translate("good morning sirs"), "bonjour sirs");
+	EXPECT_EQ(translator.translate("good  morning"), "bon  morning");
+}
@@ -0,0 +1,132 @@
+#include "Protocol.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <stdexcept>
+
+TEST(ProtocolTests, handle_status_packet) {
+	const Packet p{ PacketType::Status, { 0x03, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0b00000001 } };
+	const Status status = handle_status_packet(p);
+	EXPECT_EQ(status.nb_mails, 3);
+	EXPECT_EQ(status.connection_time, 16);
+	EXPECT_TRUE(status.authenticated);
+	EXPECT_TRUE(status.authorized);
+	EXPECT_FALSE(status.configured);
+
+	const Packet no_mail{ PacketType::Status, { 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+	EXPECT_FALSE(handle_status_packet(no_mail).nb_mails.has_value());
+
+	const Packet truncated{ PacketType::Status, { 0x03, 0x00, 0x00 } };
+	EXPECT_THROW(handle_status_packet(truncated), std::runtime_error);
+	EXPECT_FALSE(decode_status(truncated).has_value());
+}
+
+TEST(ProtocolTests, handle_mail_packet) {
+	const Packet p{ PacketType::Mail, MailSchema::encode(2, 1234, "alice", "foo bar") };
+	const Mail mail = handle_mail_packet(p);
+	EXPECT_EQ(mail.id, 2);
+	EXPECT_EQ(mail.timestamp, 1234);
+	EXPECT_EQ(mail.sender_username, "alice");
+	EXPECT_EQ(mail.content, "foo bar");
+
+	std::vector<uint8_t> payload = MailSchema::encode(2, 1234, "alice", "foo bar");
+	payload.resize(payload.size() - 1);
+	EXPECT_THROW(handle_mail_packet(Packet{ PacketType::Mail, payload }), std::runtime_error);
+	EXPECT_FALSE(decode_mail(Packet{ PacketType::Mail, payload }).has_value());
+}
+
+TEST(ProtocolTests, mail_translate) {
+	Dictionnary dict;
+	dict["foo"] = "doo";
+
+	Mail first{ 1, 0, "alice", "foo bar" };
+	first.translate(dict);
+	EXPECT_EQ(first.content, "doo bar");
+
+	// The translator is reused until the dictionnary learns a word
+	dict["bar"] = "dar";
+	Mail second{ 2, 0, "alice", "foo bar" };
+	second.translate(dict);
+	EXPECT_EQ(second.content, "doo dar");
+}
+
+TEST(ProtocolTests, mail_translate_new_dictionnary) {
+	// Same address and same number of changes, different content
+	std::string translations[2];
+	for (int i = 0; i < 2; ++i) {
+		Dictionnary dict;
+		dict["foo"] = (i == 0) ? "xxx" : "yyy";
+		Mail mail{ 1, 0, "alice", "foo bar" };
+		mail.translate(dict);
+		translations[i] = mail.content;
+	}
+	EXPECT_EQ(translations[0], "xxx bar");
+	EXPECT_EQ(translations[1], "yyy bar");
+}
+
+TEST(ProtocolTests, write_packets) {
+	const CredentialInfos credential{ { 0x01, 0x02 }, { 0x03 } };
+	const std::vector<uint8_t> login = { 0x02, 0x01, 0x02, 0x01, 0x03 };
+	EXPECT_EQ(write_login_packet(credential).payload, login);
+
+	const std::vector<uint8_t> getmail = { 0x04, 0x03, 0x02, 0x01 };
+	EXPECT_EQ(write_getmail_packet(0x01020304).payload, getmail);
+
+	const Configuration config{ 0x01020304, 0x0a0b0c0d, 0x03 };
+	const std::vector<uint8_t> configure = { 0x04, 0x03, 0x02, 0x01, 0x0d, 0x0c, 0x0b, 0x0a, 0x03 };
+	EXPECT_EQ(write_configuration_packet(config).payload, configure);
+
+	const CredentialInfos registered = handle_registered_packet(Packet{ PacketType::Registered, login });
+	EXPECT_EQ(registered.username, credential.username);
+	EXPECT_EQ(registered.password, credential.password);
+}
+
+TEST(ProtocolTests, server_infos_cache) {
+	const Packet hello{ PacketType::Hello, HelloSchema::encode(0x02, "clearsky", "hi") };
+	const Hello current = handle_hello_packet(hello);
+	EXPECT_EQ(current.protocol_version, 0x02);
+	EXPECT_EQ(current.hostname, "clearsky");
+	EXPECT_EQ(current.instruction, "hi");
+
+	EXPECT_FALSE(ServerInfos{}.is_current(current));
+
+	const ServerInfos cached{ hello.payload, { 'd', 'o', 'c' } };
+	EXPECT_TRUE(cached.is_current(current));
+	EXPECT_FALSE(cached.is_current(Hello{ 0x03, "clearsky", "hi" }));
+
+	// Read back without loading the documentation
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_server_infos.dat").string();
+	{
+		DiskWriter writer{ false };
+		ServerInfos::save_on_disk(writer, filepath, hello, Packet{ PacketType::Documentation, std::vector<uint8_t>(1000, 'd') });
+		writer.flush();
+	}
+	ServerInfos read;
+	read.read_on_disk(filepath);
+	EXPECT_TRUE(read.is_current(current));
+	EXPECT_TRUE(read.documentation.empty());
+
+	// Truncated documentation, the cache is ignored
+	std::filesystem::resize_file(filepath, std::filesystem::file_size(filepath) - 1);
+	ServerInfos truncated;
+	truncated.read_on_disk(filepath);
+	EXPECT_FALSE(truncated.is_current(current));
+
+	std::filesystem::remove(filepath);
+}
+
+TEST(ProtocolTests, sendmail_packet) {
+	const Packet p = write_sendmail_packet(OutgoingMail{ "bob", "hi" }, 0x07);
+	EXPECT_EQ(p.request_id, 0x07);
+	const std::vector<uint8_t> sendmail{ 0x03, 'b', 'o', 'b', 0x02, 0x00, 0x00, 0x00, 'h', 'i' };
+	EXPECT_EQ(p.payload, sendmail);
+
+	// Request id follows the magic on the wire
+	std::vector<char> data;
+	serialize_packet(data, p);
+	ASSERT_EQ(data.size(), packet_size(p));
+	EXPECT_EQ(data[0], static_cast<char>((1 << 6) | (1 << 5) | 0x0b));
+	EXPECT_EQ(std::string(data.begin() + 1, data.begin() + 5), "XR2K");
+	EXPECT_EQ(data[5], 0x07);
+	EXPECT_EQ(data[6], static_cast<char>(sendmail.size()));
+}
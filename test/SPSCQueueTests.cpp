@@ -0,0 +1,69 @@
+#include "SPSCQueue.hpp"
+#include <gtest/gtest.h>
+
+#include <thread>
+
+TEST(SPSCQueueTests, push_pop) {
+	SPSCQueue<int> queue{ 3 };
+	EXPECT_EQ(queue.capacity(), 4);
+
+	for (int i = 0; i < 4; ++i) {
+		int v = i;
+		EXPECT_TRUE(queue.try_push(v));
+	}
+	int overflow = 4;
+	EXPECT_FALSE(queue.try_push(overflow));
+	EXPECT_EQ(queue.size(), 4);
+
+	for (int i = 0; i < 4; ++i) {
+		int v = -1;
+		EXPECT_TRUE(queue.try_pop(v));
+		EXPECT_EQ(v, i);
+	}
+	int v;
+	EXPECT_FALSE(queue.try_pop(v));
+	EXPECT_EQ(queue.metrics().max_occupancy, 4);
+}
+
+TEST(SPSCQueueTests, max_occupancy) {
+	SPSCQueue<int> queue{ 8 };
+
+	// Every item is popped before the next push
+	for (int i = 0; i < 6; ++i) {
+		int v = i;
+		EXPECT_TRUE(queue.try_push(v));
+		EXPECT_TRUE(queue.try_pop(v));
+	}
+	EXPECT_EQ(queue.metrics().max_occupancy, 1);
+}
+
+TEST(SPSCQueueTests, close_drain) {
+	SPSCQueue<int> queue{ 4 };
+	queue.push(1);
+	queue.close();
+
+	EXPECT_EQ(queue.pop(), 1);
+	EXPECT_EQ(queue.pop(), std::nullopt);
+}
+
+TEST(SPSCQueueTests, threaded_order_and_backpressure) {
+	constexpr int nb_values = 100000;
+	SPSCQueue<int> queue{ 8 };
+
+	std::thread producer{ [&queue] {
+		for (int i = 0; i < nb_values; ++i) {
+			queue.push(i);
+		}
+		queue.close();
+	} };
+
+	int expected = 0;
+	while (std::optional<int> v = queue.pop()) {
+		ASSERT_EQ(*v, expected);
+		++expected;
+	}
+	producer.join();
+
+	EXPECT_EQ(expected, nb_values);
+	EXPECT_LE(queue.metrics().max_occupancy, queue.capacity());
+}
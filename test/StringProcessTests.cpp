@@ -12,6 +12,9 @@ TEST(StringProcessTests, is_alpha) {
 	EXPECT_FALSE(is_alpha("foo123"));
 	EXPECT_FALSE(is_alpha("123foo"));
 	EXPECT_FALSE(is_alpha(".,!;:-_#a"));
+
+	EXPECT_TRUE(is_alpha("caf\xc3\xa9"));
+	EXPECT_FALSE(is_alpha("caf\xc3"));
 }
 
 TEST(StringProcessTests, has_alphanumeric) {
@@ -70,4 +73,25 @@ TEST(StringProcessTests, translate) {
 		{ "baz", "daz" },
 	};
 	EXPECT_EQ(translate(text2, mapping2), "doo, dar: daz. doo-dar");
+
+	const std::unordered_map<std::string, std::string> mapping4 {
+		{ "\xc3\xa9t\xc3\xa9", "summer" },
+	};
+	EXPECT_EQ(translate("\xc3\x89T\xc3\x89, Foo", mapping4), "summer, foo");
+}
+
+TEST(StringProcessTests, count_words) {
+	const std::unordered_map<std::string, size_t> counts = count_words("Foo bar, foo-FOO baz2 (bar)");
+	const std::unordered_map<std::string, size_t> expected {
+		{ "foo", 3 },
+		{ "bar", 2 },
+	};
+	EXPECT_EQ(counts, expected);
+
+	// Non ASCII letters are part of words
+	const std::unordered_map<std::string, size_t> utf8_counts = count_words("\xc3\x89t\xc3\xa9\t\xc3\xa9t\xc3\xa9 12\xc2\xb0");
+	const std::unordered_map<std::string, size_t> utf8_expected {
+		{ "\xc3\xa9t\xc3\xa9", 2 },
+	};
+	EXPECT_EQ(utf8_counts, utf8_expected);
 }
@@ -0,0 +1,216 @@
+#include "TCPConnect.hpp"
+#include "Packet.hpp"
+#include "Protocol.hpp"
+#include <gtest/gtest.h>
+
+#include "Loopback.hpp"
+
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+tcp_detail::ResolvedAdress loopback_adress(uint16_t port) {
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+
+	tcp_detail::ResolvedAdress adress{ AF_INET, SOCK_STREAM, 0, {}, sizeof(addr) };
+	std::memcpy(&adress.addr, &addr, sizeof(addr));
+	return adress;
+}
+
+// Family and port tag only, never connected to
+tcp_detail::ResolvedAdress tagged_adress(int family, uint16_t tag) {
+	tcp_detail::ResolvedAdress adress = loopback_adress(tag);
+	adress.family = family;
+	return adress;
+}
+
+uint16_t tag(const tcp_detail::ResolvedAdress& adress) {
+	return ntohs(reinterpret_cast<const sockaddr_in&>(adress.addr).sin_port);
+}
+
+uint16_t peer_port(int fd) {
+	sockaddr_in addr{};
+	socklen_t length = sizeof(addr);
+	getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &length);
+	return ntohs(addr.sin_port);
+}
+
+int int_option(int fd, int level, int name) {
+	int value = -1;
+	socklen_t length = sizeof(value);
+	getsockopt(fd, level, name, &value, &length);
+	return value;
+}
+
+}
+
+TEST(TCPConnectTests, connect_and_exchange) {
+	Listener listener;
+	TCPConnect connection{ "127.0.0.1", std::to_string(listener.port) };
+
+	const int peer = accept(listener.fd, nullptr, nullptr);
+	ASSERT_GE(peer, 0);
+
+	connection.send({ 'f', 'o', 'o' });
+	char buff[3];
+	ASSERT_EQ(::recv(peer, buff, 3, MSG_WAITALL), 3);
+	EXPECT_EQ(std::string(buff, 3), "foo");
+
+	::send(peer, "bar", 3, 0);
+	EXPECT_EQ(connection.recv(), 3);
+	EXPECT_EQ(connection.bytes().size(), 3);
+
+	close(peer);
+}
+
+TEST(TCPConnectTests, fallback_to_ipv4) {
+	// localhost usually resolves to ::1 first, nobody listens there
+	Listener listener;
+	TCPOptions options;
+	options.attempt_delay = std::chrono::milliseconds{ 10 };
+	options.recv_buffer_size = 1 << 16;
+	EXPECT_NO_THROW(TCPConnect("localhost", std::to_string(listener.port), options));
+}
+
+TEST(TCPConnectTests, socket_options) {
+	Listener listener;
+	TCPOptions options;
+	options.recv_buffer_size = 1 << 16;
+	options.send_buffer_size = 1 << 17;
+	const TCPConnect connection{ "127.0.0.1", std::to_string(listener.port), options };
+
+	const int fd = connection.native_handle();
+	EXPECT_NE(int_option(fd, IPPROTO_TCP, TCP_NODELAY), 0);
+	// The kernel doubles the requested sizes for its bookkeeping
+	EXPECT_EQ(int_option(fd, SOL_SOCKET, SO_RCVBUF), 2 * (1 << 16));
+	EXPECT_EQ(int_option(fd, SOL_SOCKET, SO_SNDBUF), 2 * (1 << 17));
+
+	TCPOptions nagle;
+	nagle.no_delay = false;
+	const TCPConnect delayed{ "127.0.0.1", std::to_string(listener.port), nagle };
+	EXPECT_EQ(int_option(delayed.native_handle(), IPPROTO_TCP, TCP_NODELAY), 0);
+}
+
+TEST(TCPConnectTests, interleave_families) {
+	const std::vector<tcp_detail::ResolvedAdress> resolved = {
+		tagged_adress(AF_INET, 1), tagged_adress(AF_INET, 2), tagged_adress(AF_INET6, 3),
+		tagged_adress(AF_INET, 4), tagged_adress(AF_INET6, 5),
+	};
+
+	// IPv6 first, then alternating, each family keeping its order
+	const std::vector<tcp_detail::ResolvedAdress> adresses = tcp_detail::interleave_families(resolved);
+	ASSERT_EQ(adresses.size(), 5);
+	const uint16_t expected[] = { 3, 1, 5, 2, 4 };
+	for (size_t i = 0; i < adresses.size(); ++i) {
+		EXPECT_EQ(tag(adresses[i]), expected[i]) << i;
+	}
+}
+
+TEST(TCPConnectTests, staggered_attempts) {
+	Listener first;
+	Listener second;
+	TCPOptions options;
+	options.attempt_delay = std::chrono::milliseconds{ 200 };
+
+	// The first adress answering within attempt_delay, the second one is never tried
+	{
+		const int fd = tcp_detail::connect_any({ loopback_adress(first.port), loopback_adress(second.port) }, options);
+		ASSERT_GE(fd, 0);
+		EXPECT_EQ(peer_port(fd), first.port);
+		pollfd pending{ second.fd, POLLIN, 0 };
+		EXPECT_EQ(poll(&pending, 1, 50), 0);
+		close(fd);
+		close(accept(first.fd, nullptr, nullptr));
+	}
+
+	// A full accept queue leaves the first attempt pending, the second one starts after attempt_delay
+	listen(first.fd, 0);
+	const int queued = socket(AF_INET, SOCK_STREAM, 0);
+	const tcp_detail::ResolvedAdress stalled = loopback_adress(first.port);
+	ASSERT_EQ(connect(queued, reinterpret_cast<const sockaddr*>(&stalled.addr), stalled.addr_length), 0);
+
+	const auto start = std::chrono::steady_clock::now();
+	const int fd = tcp_detail::connect_any({ stalled, loopback_adress(second.port) }, options);
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	ASSERT_GE(fd, 0);
+	EXPECT_EQ(peer_port(fd), second.port);
+	EXPECT_GE(elapsed, options.attempt_delay);
+	EXPECT_LT(elapsed, options.attempt_timeout);
+	close(fd);
+	close(accept(second.fd, nullptr, nullptr));
+
+	// A refused attempt hands its turn over at once, the pending one does not hold the next back
+	uint16_t closed_port;
+	{
+		Listener gone;
+		closed_port = gone.port;
+	}
+	const auto refused_start = std::chrono::steady_clock::now();
+	const int refused_fd = tcp_detail::connect_any({ stalled, loopback_adress(closed_port), loopback_adress(second.port) }, options);
+	const auto refused_elapsed = std::chrono::steady_clock::now() - refused_start;
+	ASSERT_GE(refused_fd, 0);
+	EXPECT_EQ(peer_port(refused_fd), second.port);
+	EXPECT_LT(refused_elapsed, 2 * options.attempt_delay);
+
+	close(refused_fd);
+	close(queued);
+}
+
+TEST(TCPConnectTests, no_listener_throw) {
+	uint16_t port;
+	{
+		Listener listener;
+		port = listener.port;
+	}
+	TCPConnect::clear_address_cache();
+	EXPECT_THROW(TCPConnect("127.0.0.1", std::to_string(port)), std::runtime_error);
+}
+
+TEST(TCPConnectTests, spill_large_payload) {
+	Listener listener;
+	TCPOptions options;
+	options.spill_threshold = 1024;
+	TCPConnect connection{ "127.0.0.1", std::to_string(listener.port), options };
+
+	const int peer = accept(listener.fd, nullptr, nullptr);
+	ASSERT_GE(peer, 0);
+
+	const std::string content(1 << 20, 'x');
+	std::vector<char> data;
+	serialize_packet(data, Packet{ PacketType::Mail, MailSchema::encode(7, 1234, "alice", content) });
+	serialize_packet(data, Packet{ PacketType::Result, ResultSchema::encode(0x00) });
+	// Larger than the socket buffers
+	std::thread sender{ [peer, &data] {
+		::send(peer, data.data(), data.size(), 0);
+	} };
+
+	const Packet mail_packet = recv_packet(connection);
+	EXPECT_TRUE(mail_packet.payload.empty());
+	ASSERT_NE(mail_packet.spilled_payload, nullptr);
+	const Mail mail = handle_mail_packet(mail_packet);
+	EXPECT_EQ(mail.id, 7);
+	// The content is read from the mapping, never copied
+	EXPECT_TRUE(mail.content.empty());
+	EXPECT_EQ(mail.spilled_payload, mail_packet.spilled_payload);
+	EXPECT_EQ(mail.text(), content);
+
+	// Small packets stay in memory, the stream is still in sync
+	const Packet result_packet = recv_packet(connection);
+	EXPECT_EQ(result_packet.spilled_payload, nullptr);
+	EXPECT_TRUE(handle_result_packet(result_packet).success());
+
+	sender.join();
+	close(peer);
+}
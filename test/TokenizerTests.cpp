@@ -0,0 +1,49 @@
+#include "Tokenizer.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(TokenizerTests, utf8) {
+	size_t length = 0;
+	EXPECT_EQ(utf8::decode("\xc3\xa9", 0, length), U'é');
+	EXPECT_EQ(length, 2);
+	EXPECT_EQ(utf8::decode("\xe2\x82\xac", 0, length), U'€');
+	EXPECT_EQ(length, 3);
+
+	// Truncated, overlong and surrogate sequences
+	EXPECT_EQ(utf8::decode("\xc3", 0, length), std::nullopt);
+	EXPECT_EQ(length, 1);
+	EXPECT_EQ(utf8::decode("\xc0\xaf", 0, length), std::nullopt);
+	EXPECT_EQ(utf8::decode("\xed\xa0\x80", 0, length), std::nullopt);
+
+	EXPECT_TRUE(utf8::is_letter(U'é'));
+	EXPECT_TRUE(utf8::is_letter(U'Ж'));
+	EXPECT_FALSE(utf8::is_letter(U'×'));
+	EXPECT_FALSE(utf8::is_letter(U'€'));
+
+	EXPECT_EQ(utf8::to_lower(U'É'), U'é');
+	EXPECT_EQ(utf8::to_lower(U'Ā'), U'ā');
+	EXPECT_EQ(utf8::to_lower(U'ā'), U'ā');
+	EXPECT_EQ(utf8::to_lower(U'Ÿ'), U'ÿ');
+	EXPECT_EQ(utf8::to_lower(U'Σ'), U'σ');
+	EXPECT_EQ(utf8::to_lower(U'Ж'), U'ж');
+}
+
+TEST(TokenizerTests, fold) {
+	const Tokenizer& tokenizer = default_tokenizer();
+	EXPECT_EQ(tokenizer.fold("Hello, WORLD.\tFoo"), "hello, world.\tfoo");
+	EXPECT_EQ(tokenizer.fold("\xc3\x89T\xc3\x89 (\xd0\x96)"), "\xc3\xa9t\xc3\xa9 (\xd0\xb6)");
+	// Invalid bytes are kept
+	EXPECT_EQ(tokenizer.fold("A\xff" "B"), "a\xff" "b");
+}
+
+TEST(TokenizerTests, words) {
+	const Tokenizer tokenizer{ " " };
+	std::vector<std::string> words;
+	tokenizer.for_each_word("Caf\xc3\xa9 ABCDEFGHIJ a,b x2 \xff  na\xc3\xafve", [&words](const std::string& word) {
+		words.push_back(word);
+	});
+
+	const std::vector<std::string> expected{ "caf\xc3\xa9", "abcdefghij", "na\xc3\xafve" };
+	EXPECT_EQ(words, expected);
+}
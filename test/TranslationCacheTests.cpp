@@ -0,0 +1,137 @@
+#include "TranslationCache.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+TEST(TranslationCacheTests, hit_and_invalidation) {
+	Dictionnary dict;
+	dict["foo"] = "doo";
+
+	TranslationCache cache;
+	const std::string mail1 = "foo bar";
+	const std::string mail2 = "foo baz";
+	EXPECT_EQ(cache.find(mail1, dict), nullptr);
+
+	const CachedTranslation& first = cache.translate(mail1, dict);
+	EXPECT_EQ(first.content, "doo bar");
+	EXPECT_EQ(first.nb_words, 2);
+	EXPECT_EQ(first.nb_translated_words, 1);
+	EXPECT_FALSE(first.complete());
+	cache.translate(mail2, dict);
+
+	ASSERT_NE(cache.find(mail1, dict), nullptr);
+	EXPECT_EQ(cache.find(mail1, dict)->content, "doo bar");
+
+	// Learning bar only invalidates the first mail
+	dict["bar"] = "dar";
+	EXPECT_EQ(cache.find(mail1, dict), nullptr);
+	EXPECT_NE(cache.find(mail2, dict), nullptr);
+
+	const CachedTranslation& updated = cache.translate(mail1, dict);
+	EXPECT_EQ(updated.content, "doo dar");
+	EXPECT_TRUE(updated.complete());
+}
+
+TEST(TranslationCacheTests, phrase_invalidation) {
+	Dictionnary dict;
+	dict["foo"] = "doo";
+
+	TranslationCache cache;
+	EXPECT_EQ(cache.translate("foo bar baz", dict).content, "doo bar baz");
+
+	// A phrase may match any content
+	dict["bar baz"] = "qux";
+	EXPECT_EQ(cache.find("foo bar baz", dict), nullptr);
+	EXPECT_EQ(cache.translate("foo bar baz", dict).content, "doo qux");
+}
+
+TEST(TranslationCacheTests, save_and_read) {
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_translation_cache.dat").string();
+
+	Dictionnary dict;
+	dict["foo"] = "doo";
+	{
+		TranslationCache cache;
+		cache.translate("foo bar", dict);
+		cache.translate("foo, foo.", dict);
+		cache.save_on_disk(filepath);
+	}
+
+	TranslationCache cache;
+	cache.read_on_disk(filepath);
+	EXPECT_EQ(cache.size(), 2);
+
+	const CachedTranslation* cached = cache.find("foo bar", dict);
+	ASSERT_NE(cached, nullptr);
+	EXPECT_EQ(cached->content, "doo bar");
+	EXPECT_EQ(cached->nb_words, 2);
+	EXPECT_EQ(cached->nb_translated_words, 1);
+	ASSERT_NE(cache.find("foo, foo.", dict), nullptr);
+	EXPECT_TRUE(cache.find("foo, foo.", dict)->complete());
+
+	std::filesystem::remove(filepath);
+}
+
+TEST(TranslationCacheTests, key_collision) {
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_translation_cache_collision.dat").string();
+
+	Dictionnary dict;
+	dict["foo"] = "doo";
+
+	// Record of another content sharing the key of "foo bar"
+	const std::vector<uint8_t> record = TranslationCache::RecordSchema::encode(content_hash("foo bar"), 3, 0, 0, 0, "", "wrong");
+	const std::vector<uint8_t> size = schema::Schema<schema::LE<uint32_t>>::encode(static_cast<uint32_t>(record.size()));
+	{
+		std::ofstream outfile{ filepath, std::ios::binary };
+		outfile.write(reinterpret_cast<const char*>(size.data()), size.size());
+		outfile.write(reinterpret_cast<const char*>(record.data()), record.size());
+	}
+
+	TranslationCache cache;
+	cache.read_on_disk(filepath);
+	EXPECT_EQ(cache.size(), 1);
+	EXPECT_EQ(cache.find("foo bar", dict), nullptr);
+	EXPECT_EQ(cache.translate("foo bar", dict).content, "doo bar");
+	EXPECT_EQ(cache.size(), 1);
+
+	std::filesystem::remove(filepath);
+}
+
+TEST(TranslationCacheTests, bounded_size) {
+	Dictionnary dict;
+	dict["foo"] = "doo";
+
+	// The least recently used entry is evicted
+	TranslationCache cache{ 2 };
+	cache.translate("foo a", dict);
+	cache.translate("foo b", dict);
+	EXPECT_NE(cache.find("foo a", dict), nullptr);
+	cache.translate("foo c", dict);
+	EXPECT_EQ(cache.size(), 2);
+	EXPECT_NE(cache.find("foo a", dict), nullptr);
+	EXPECT_EQ(cache.find("foo b", dict), nullptr);
+	EXPECT_NE(cache.find("foo c", dict), nullptr);
+
+	// Only the listed contents are kept
+	const std::string current = "foo c";
+	cache.retain({ current, "unknown" });
+	EXPECT_EQ(cache.size(), 1);
+	EXPECT_NE(cache.find("foo c", dict), nullptr);
+}
+
+TEST(TranslationCacheTests, new_dictionnary) {
+	TranslationCache cache;
+
+	// Same address and same number of changes, different content
+	std::string translations[2];
+	for (int i = 0; i < 2; ++i) {
+		Dictionnary dict;
+		dict["foo"] = (i == 0) ? "xxx" : "yyy";
+		translations[i] = cache.translate("foo bar", dict).content;
+	}
+	EXPECT_EQ(translations[0], "xxx bar");
+	EXPECT_EQ(translations[1], "yyy bar");
+}
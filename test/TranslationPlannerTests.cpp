@@ -0,0 +1,60 @@
+#include "TranslationPlanner.hpp"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+TEST(TranslationPlannerTests, most_frequent_first) {
+	const std::vector<Mail> mails = {
+		Mail{ 1, 0, "alice", "foo bar foo" },
+		Mail{ 2, 0, "bob", "baz foo, qux qux qux." },
+	};
+	Dictionnary dict;
+	dict["qux"] = "known";
+
+	TranslationPlanner planner{ mails, dict };
+	EXPECT_EQ(planner.remaining(), 3);
+	EXPECT_DOUBLE_EQ(planner.coverage(), 3.0 / 8.0);
+
+	ASSERT_FALSE(planner.done());
+	EXPECT_EQ(planner.next().word, "foo");
+	EXPECT_EQ(planner.next().occurrences, 3);
+	EXPECT_EQ(planner.next().mails, (std::vector<size_t>{ 0, 1 }));
+	planner.pop(true);
+	EXPECT_DOUBLE_EQ(planner.coverage(), 6.0 / 8.0);
+
+	// Same frequency, alphabetical order
+	EXPECT_EQ(planner.next().word, "bar");
+	EXPECT_EQ(planner.next().mails, std::vector<size_t>{ 0 });
+	planner.pop(false);
+	EXPECT_DOUBLE_EQ(planner.coverage(), 6.0 / 8.0);
+
+	EXPECT_EQ(planner.next().word, "baz");
+	planner.pop(true);
+	EXPECT_TRUE(planner.done());
+}
+
+TEST(TranslationPlannerTests, skip_rejected_words) {
+	const std::string filepath = (std::filesystem::temp_directory_path() / "xr2000_rejected_words.txt").string();
+
+	const std::vector<Mail> mails = {
+		Mail{ 1, 0, "alice", "the foo the" },
+	};
+	Dictionnary dict;
+
+	RejectedWords saved;
+	saved.words.insert("the");
+	saved.save_on_disk(filepath);
+
+	RejectedWords rejected;
+	rejected.read_on_disk(filepath);
+	EXPECT_TRUE(rejected.contains("the"));
+
+	// Never asked again, not part of the coverage
+	TranslationPlanner planner{ mails, dict, rejected };
+	EXPECT_EQ(planner.remaining(), 1);
+	EXPECT_EQ(planner.next().word, "foo");
+	planner.pop(true);
+	EXPECT_DOUBLE_EQ(planner.coverage(), 1.0);
+
+	std::filesystem::remove(filepath);
+}